@@ -3,28 +3,65 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
-#include <functional>
 #include <memory>
 #include <algorithm>
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory_resource>
+#include <cmath>
+
+// Inline storage, in bytes, of every animation callback. Captures larger than
+// this are rejected at compile time. Must be identical in every translation unit.
+#ifndef ANIM_CALLBACK_CAPACITY
+#define ANIM_CALLBACK_CAPACITY 32
+#endif
+
+// Counts the allocations every AnimationWorld makes, see AllocationCount().
+// On by default in debug builds.
+#ifndef ANIM_COUNT_ALLOCATIONS
+#ifdef NDEBUG
+#define ANIM_COUNT_ALLOCATIONS 0
+#else
+#define ANIM_COUNT_ALLOCATIONS 1
+#endif
+#endif
 
 #ifdef ANIM_NAMESPACE
 namespace Anim {
 #endif
 
-typedef size_t AnimationId;
-
 struct _MapHandleSlot {
     uint32_t slot_index = 0;
     uint32_t generation = 0;
 };
 
-template <typename T>
-class _SlotMap {
+class _SlotIndex {
 
 public:
 
-    _MapHandleSlot insert(T value) {
+    _SlotIndex(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_slots(resource), m_dense(resource), m_free_slots(resource) { }
+
+    _MapHandleSlot insert() {
+        _MapHandleSlot handle = acquire();
+        bind(handle);
+        return handle;
+    }
+
+    // Allocates a live handle without a dense entry yet. It must be passed to
+    // bind() before it is used to index into the owner's storage.
+    _MapHandleSlot acquire() {
 
         uint32_t slot_index;
 
@@ -37,13 +74,16 @@ public:
         }
 
         m_slots[slot_index].active = true;
-        m_slots[slot_index].data_index = m_data.size();
-
-        m_data.push_back({ value, slot_index });
+        m_slots[slot_index].data_index = UINT32_MAX;
 
         return { slot_index, m_slots[slot_index].generation };
     }
 
+    void bind(_MapHandleSlot handle) {
+        m_slots[handle.slot_index].data_index = (uint32_t)m_dense.size();
+        m_dense.push_back(handle.slot_index);
+    }
+
     bool is_valid(_MapHandleSlot handle) const {
         return 
         handle.slot_index < m_slots.size() &&
@@ -51,43 +91,86 @@ public:
         m_slots[handle.slot_index].generation == handle.generation;
     }
 
-    T* get(_MapHandleSlot handle) {
-        if (!is_valid(handle)) return nullptr;
-        return &m_data[m_slots[handle.slot_index].data_index].value;
+    uint32_t index_of(_MapHandleSlot handle) const {
+        return m_slots[handle.slot_index].data_index;
     }
 
-    void erase(_MapHandleSlot handle) {
-        if (!is_valid(handle)) return;
+    // Releases a valid handle and returns the dense index it occupied. The
+    // owner must move its last element into that index and pop the back.
+    uint32_t erase(_MapHandleSlot handle) {
 
         uint32_t slot_index = handle.slot_index;
-        uint32_t data_index = m_slots[handle.slot_index].data_index;
+        uint32_t data_index = m_slots[slot_index].data_index;
 
         m_slots[slot_index].active = false;
         m_slots[slot_index].generation++;
         m_free_slots.push_back(slot_index);
 
-        if (data_index < (uint32_t)m_data.size() - 1) {
-            m_data[data_index] = std::move(m_data.back());
-            m_slots[m_data[data_index].slot_index].data_index = data_index;
+        if (data_index < (uint32_t)m_dense.size() - 1) {
+            m_dense[data_index] = m_dense.back();
+            m_slots[m_dense[data_index]].data_index = data_index;
         }
 
-        m_data.pop_back();
+        m_dense.pop_back();
 
+        return data_index;
     }
 
-	size_t size() const { return m_data.size(); }
-	T& operator[](size_t index) { return m_data[index].value; }
+    size_t size() const { return m_dense.size(); }
 
-	_MapHandleSlot get_handle_at(size_t index) {
-		return { m_data[index].slot_index, m_slots[m_data[index].slot_index].generation };
-	}
+    void reserve(size_t capacity) {
+        m_slots.reserve(capacity);
+        m_dense.reserve(capacity);
+        m_free_slots.reserve(capacity);
+    }
 
-private:
+    size_t reserved() const { return m_dense.capacity(); }
 
-    struct Item {
-        T value;
-        uint32_t slot_index = 0;
-    };
+    // Caps the number of live handles (SIZE_MAX lifts the cap). Owners refuse
+    // inserts while full(), so storage reserved up to the cap never reallocates.
+    void limit(size_t capacity) { m_capacity = capacity; }
+
+    bool full() const { return m_slots.size() - m_free_slots.size() >= m_capacity; }
+
+    // Handles that can still be acquired under a hard capacity.
+    size_t available() const {
+        size_t live = m_slots.size() - m_free_slots.size();
+        return m_capacity == SIZE_MAX ? SIZE_MAX : m_capacity > live ? m_capacity - live : 0;
+    }
+
+    _MapHandleSlot get_handle_at(size_t index) const {
+        return { m_dense[index], m_slots[m_dense[index]].generation };
+    }
+
+    void swap(uint32_t a, uint32_t b) {
+        std::swap(m_dense[a], m_dense[b]);
+        m_slots[m_dense[a]].data_index = a;
+        m_slots[m_dense[b]].data_index = b;
+    }
+
+    // The dense array is split into an active prefix [0, active()) and the
+    // parked entries after it. New entries start out parked.
+    size_t active() const { return m_active; }
+    bool parked(uint32_t index) const { return index >= m_active; }
+
+    // Move an entry across the boundary by swapping it with the entry at the
+    // edge and return its new index. The owner swaps its columns to match.
+    // An entry must be parked before it is erased.
+    uint32_t park(uint32_t index) {
+        if (index >= m_active) return index;
+        uint32_t edge = (uint32_t)--m_active;
+        swap(index, edge);
+        return edge;
+    }
+
+    uint32_t unpark(uint32_t index) {
+        if (index < m_active) return index;
+        uint32_t edge = (uint32_t)m_active++;
+        swap(index, edge);
+        return edge;
+    }
+
+private:
 
     struct Slot {
         uint32_t data_index = 0;
@@ -95,209 +178,3580 @@ private:
         bool active = false;
     };
 
-    std::vector<Item> m_data = { };
-    std::vector<Slot> m_slots = { };
-    std::vector<uint32_t> m_free_slots = { };
-    
+    std::pmr::vector<Slot> m_slots;
+    std::pmr::vector<uint32_t> m_dense;
+    std::pmr::vector<uint32_t> m_free_slots;
+    size_t m_active = 0;
+    size_t m_capacity = SIZE_MAX;
+
 };
 
+template <typename V>
+void _SwapRemove(V& column, uint32_t index) {
+    if (index < (uint32_t)column.size() - 1) column[index] = std::move(column.back());
+    column.pop_back();
+}
+
 typedef _MapHandleSlot InstanceId;
 
-typedef std::function<void()> AnimationOnStartFunction;
-typedef std::function<void(void*)> AnimationOnEachRepeatStart;
-typedef std::function<void(float, void*)> AnimationUpdateFunction;
-typedef std::function<void(void*)> AnimationOnEachRepeatEnd;
-typedef std::function<void()> AnimationOnEnd;
+// Handle of an animation template. Kept apart from InstanceId so that one can
+// not be passed where the other is expected.
+struct AnimationId {
+	_MapHandleSlot handle = { };
+};
+
+// Returned by AttachAnimation when a hard capacity is full. Never valid.
+inline constexpr InstanceId ANIM_INVALID_INSTANCE = { UINT32_MAX, 0 };
+
+// Number of time scale groups; group masks are 32-bit.
+inline constexpr uint32_t ANIM_GROUP_COUNT = 32;
+
+template <typename Signature, size_t Capacity = ANIM_CALLBACK_CAPACITY>
+class _InlineFunction;
+
+// Fixed-size replacement for std::function that never allocates. Callables that
+// are trivially copyable (plain lambdas capturing pointers, references and PODs)
+// are copied with a memcpy; others go through a small manager function.
+template <typename R, typename... Args, size_t Capacity>
+class _InlineFunction<R(Args...), Capacity> {
+
+public:
+
+	_InlineFunction() = default;
+	_InlineFunction(std::nullptr_t) { }
+
+	template <typename F, typename Fn = std::decay_t<F>, typename = std::enable_if_t<
+		!std::is_same_v<Fn, _InlineFunction> && std::is_invocable_r_v<R, Fn&, Args...>>>
+	_InlineFunction(F&& f) {
+
+		static_assert(sizeof(Fn) <= Capacity, "Callable does not fit in the animation callback storage, raise ANIM_CALLBACK_CAPACITY or capture less");
+		static_assert(alignof(Fn) <= alignof(std::max_align_t), "Over-aligned callables are not supported");
+
+		if constexpr (std::is_pointer_v<Fn>) {
+			if (f == nullptr) return;
+		}
+
+		::new (static_cast<void*>(m_storage)) Fn(std::forward<F>(f));
+
+		m_invoke = [](void* storage, Args... args) -> R {
+			return (*std::launder(reinterpret_cast<Fn*>(storage)))(std::forward<Args>(args)...);
+		};
+
+		if constexpr (!std::is_trivially_copyable_v<Fn>) {
+			m_manage = [](_Operation op, void* dst, void* src) {
+				Fn* from = std::launder(reinterpret_cast<Fn*>(src));
+				switch (op) {
+					case OP_COPY: ::new (dst) Fn(*from); break;
+					case OP_MOVE: ::new (dst) Fn(std::move(*from)); from->~Fn(); break;
+					case OP_DESTROY: from->~Fn(); break;
+				}
+			};
+		}
+	}
+
+	_InlineFunction(const _InlineFunction& other) { copy_from(other); }
+	_InlineFunction(_InlineFunction&& other) noexcept { move_from(other); }
+
+	_InlineFunction& operator=(const _InlineFunction& other) {
+		if (this != &other) { reset(); copy_from(other); }
+		return *this;
+	}
+
+	_InlineFunction& operator=(_InlineFunction&& other) noexcept {
+		if (this != &other) { reset(); move_from(other); }
+		return *this;
+	}
+
+	_InlineFunction& operator=(std::nullptr_t) {
+		reset();
+		return *this;
+	}
+
+	~_InlineFunction() { reset(); }
+
+	explicit operator bool() const { return m_invoke != nullptr; }
+
+	R operator()(Args... args) const {
+		return m_invoke(const_cast<unsigned char*>(m_storage), std::forward<Args>(args)...);
+	}
+
+	void reset() {
+		if (m_manage) m_manage(OP_DESTROY, nullptr, m_storage);
+		m_invoke = nullptr;
+		m_manage = nullptr;
+	}
+
+private:
+
+	enum _Operation { OP_COPY, OP_MOVE, OP_DESTROY };
+
+	void copy_from(const _InlineFunction& other) {
+		if (other.m_manage) other.m_manage(OP_COPY, m_storage, const_cast<unsigned char*>(other.m_storage));
+		else std::memcpy(m_storage, other.m_storage, Capacity);
+		m_invoke = other.m_invoke;
+		m_manage = other.m_manage;
+	}
+
+	void move_from(_InlineFunction& other) {
+		if (other.m_manage) other.m_manage(OP_MOVE, m_storage, other.m_storage);
+		else std::memcpy(m_storage, other.m_storage, Capacity);
+		m_invoke = other.m_invoke;
+		m_manage = other.m_manage;
+		other.m_invoke = nullptr;
+		other.m_manage = nullptr;
+	}
+
+	alignas(std::max_align_t) unsigned char m_storage[Capacity] = { };
+	R (*m_invoke)(void*, Args...) = nullptr;
+	void (*m_manage)(_Operation, void*, void*) = nullptr;
+
+};
+
+typedef _InlineFunction<void()> AnimationOnStartFunction;
+typedef _InlineFunction<void(void*)> AnimationOnEachRepeatStart;
+typedef _InlineFunction<void(float, void*)> AnimationUpdateFunction;
+typedef _InlineFunction<void(void*)> AnimationOnEachRepeatEnd;
+typedef _InlineFunction<void()> AnimationOnEnd;
+typedef _InlineFunction<void(const float*, void* const*, size_t)> AnimationUpdateBatchFunction;
 
 struct AnimationEvents {
-	std::function<void()> onStart = nullptr;
-	std::function<void(void*)> onEachRepeatStart = nullptr;
+	AnimationOnStartFunction onStart = nullptr;
+	AnimationOnEachRepeatStart onEachRepeatStart = nullptr;
 	AnimationUpdateFunction onUpdate = nullptr;
-	std::function<void(void*)> onEachRepeatEnd = nullptr;
-	std::function<void()> onEnd = nullptr;
+	AnimationOnEachRepeatEnd onEachRepeatEnd = nullptr;
+	AnimationOnEnd onEnd = nullptr;
+
+	// Template only. Receives the progress and object of every running instance
+	// of the template in one call per frame, replacing onUpdate for instances
+	// that do not override it.
+	AnimationUpdateBatchFunction onUpdateBatch = nullptr;
 };
 
-enum AnimationState {
+enum AnimationState : uint8_t {
 	ANIM_STARTING = 0,
 	ANIM_RUNNING,
 	ANIM_PAUSED,
 	ANIM_STOPPING,
 	ANIM_FINISHED,
+	ANIM_SLEEPING,
 };
 
+// ANIM_PINGPONG alternates direction every cycle, starting forward; each leg
+// counts as one repeat.
+enum AnimationDirection : uint8_t {
+	ANIM_FORWARD = 0,
+	ANIM_REVERSE,
+	ANIM_PINGPONG,
+};
+
+enum AnimationEasing : uint8_t {
+	EASE_LINEAR = 0,
+	EASE_IN_QUAD,
+	EASE_OUT_QUAD,
+	EASE_IN_OUT_QUAD,
+	EASE_IN_CUBIC,
+	EASE_OUT_CUBIC,
+	EASE_IN_OUT_CUBIC,
+	EASE_IN_QUART,
+	EASE_OUT_QUART,
+	EASE_IN_OUT_QUART,
+	EASE_IN_EXPO,
+	EASE_OUT_EXPO,
+	EASE_IN_OUT_EXPO,
+	EASE_IN_SINE,
+	EASE_OUT_SINE,
+	EASE_IN_OUT_SINE,
+	EASE_IN_BACK,
+	EASE_OUT_BACK,
+	EASE_IN_OUT_BACK,
+	EASE_IN_ELASTIC,
+	EASE_OUT_ELASTIC,
+	EASE_IN_OUT_ELASTIC,
+	EASE_IN_BOUNCE,
+	EASE_OUT_BOUNCE,
+	EASE_IN_OUT_BOUNCE,
+
+	// Curve of a template created with a CubicBezier; linear anywhere else.
+	EASE_CUBIC_BEZIER,
+};
+
+// CSS cubic-bezier(x1, y1, x2, y2). x1 and x2 must lie in [0, 1].
+struct CubicBezier {
+	float x1 = 0.0f;
+	float y1 = 0.0f;
+	float x2 = 1.0f;
+	float y2 = 1.0f;
+};
+
+float Ease(AnimationEasing easing, float t);
+
+// Applies one easing to `count` progress values. Polynomial and bounce easings
+// run on SSE, AVX2 or NEON when the target supports them; in and out may alias.
+void EaseBatch(AnimationEasing easing, const float* in, float* out, size_t count);
+
+class Animation;
+
 struct AnimationInstance {
 
 	InstanceId id = { };
 
 	void* obj = nullptr;
-	AnimationEvents events = { };
+	Animation* animation = nullptr;
 
 	enum AnimationState state = ANIM_STARTING;
+	AnimationEasing easing = EASE_LINEAR;
+	AnimationDirection direction = ANIM_FORWARD;
 
 	float duration = 0.0f;
 	size_t repeat = 0;
 	
 	float time = 0.0f;
 	size_t repeat_count = 0;
+
+	float delay = 0.0f;
+	float repeat_delay = 0.0f;
+};
+
+// Slot map specialised for AnimationInstance, stored as parallel columns so the
+// update loop only streams the hot fields (time, duration, state, repeat) and
+// touches the cold callback column when an event actually fires.
+//
+// The dense range is split in two: instances in [0, active()) are updated every
+// frame, the rest are parked (paused or waiting on a delay) and never visited.
+// New instances are inserted parked and activated with unpark().
+//
+// Callbacks are not copied per instance: each instance points at its Animation
+// template and only instances attached with overrides own a merged copy of the
+// events, kept in a deque so callbacks never move while they are running.
+class _InstancePool {
+
+public:
+
+	_InstancePool(std::pmr::memory_resource* resource);
+
+	InstanceId acquire() { return m_index.acquire(); }
+	void reserve(size_t capacity, bool hard);
+	bool full() const { return m_index.full(); }
+	size_t available() const { return m_index.available(); }
+
+	// Appends `count` parked copies of `instance` with their own objects and
+	// durations (`durations` advances by `stride`, 0 repeats one value) and
+	// writes their handles to `ids` if given.
+	void insert_batch(const AnimationInstance& instance, void* const* objs, const float* durations, size_t stride,
+		size_t count, const AnimationEvents* overrides, InstanceId* ids);
+	void insert(InstanceId reserved, const AnimationInstance& instance, const AnimationEvents* overrides);
+	void erase(InstanceId id);
+
+	const AnimationEvents& events(size_t index) const;
+	bool batched(size_t index) const;
+
+	bool is_valid(InstanceId id) const { return m_index.is_valid(id); }
+	uint32_t index_of(InstanceId id) const { return m_index.index_of(id); }
+
+	size_t size() const { return m_index.size(); }
+	InstanceId get_handle_at(size_t index) const { return m_index.get_handle_at(index); }
+
+	size_t active() const { return m_index.active(); }
+	bool parked(uint32_t index) const { return m_index.parked(index); }
+
+	// Both return the new dense index of the moved instance.
+	uint32_t park(uint32_t index);
+	uint32_t unpark(uint32_t index);
+
+	std::pmr::vector<float> time;
+	std::pmr::vector<float> duration;
+	std::pmr::vector<AnimationState> state;
+	std::pmr::vector<AnimationEasing> easing;
+	std::pmr::vector<size_t> repeat;
+	std::pmr::vector<size_t> repeat_count;
+	std::pmr::vector<void*> obj;
+
+	std::pmr::vector<Animation*> animation;
+	std::pmr::vector<uint32_t> overrides;
+
+	std::pmr::vector<float> repeat_delay;
+	std::pmr::vector<uint64_t> wake;
+	std::pmr::vector<AnimationState> resume;
+
+	std::pmr::vector<uint32_t> tags;
+
+	// rate = speed * scale of the group, kept packed so the time step stays a
+	// plain multiply-add over contiguous floats.
+	std::pmr::vector<float> rate;
+	std::pmr::vector<float> speed;
+	std::pmr::vector<uint8_t> group;
+
+	// reversed is the direction of the current cycle, flipped every cycle end
+	// for ANIM_PINGPONG.
+	std::pmr::vector<AnimationDirection> direction;
+	std::pmr::vector<uint8_t> reversed;
+
+	// Timeline playhead at the last update, NaN at the start of a cycle.
+	std::pmr::vector<float> cursor;
+	// Keyframe segment of the last sample, UINT32_MAX when unknown.
+	std::pmr::vector<uint32_t> segment;
+
+private:
+
+	template <typename F>
+	void for_each_column(F f) {
+		f(time); f(duration); f(state); f(easing); f(repeat); f(repeat_count); f(obj);
+		f(animation); f(overrides); f(repeat_delay); f(wake); f(resume); f(tags);
+		f(rate); f(speed); f(group); f(direction); f(reversed); f(cursor); f(segment);
+	}
+
+	void swap_columns(uint32_t a, uint32_t b);
+
+	_SlotIndex m_index;
+
+	std::pmr::deque<AnimationEvents> m_override_events;
+	std::pmr::vector<uint32_t> m_free_overrides;
+
+};
+
+// Composes templates into a choreography. Then() starts a step after everything
+// added so far, With() starts one alongside the previous step (plus `offset`),
+// Wait() leaves a gap. Timelines nest through the Timeline overloads.
+class Timeline {
+
+public:
+
+	Timeline& Then(AnimationId id, float duration);
+	Timeline& Then(const Timeline& timeline);
+	Timeline& With(AnimationId id, float duration, float offset = 0.0f);
+	Timeline& With(const Timeline& timeline, float offset = 0.0f);
+	Timeline& Wait(float seconds);
+
+	float Duration() const { return m_end; }
+
+private:
+
+	friend class AnimationWorld;
+
+	struct Step {
+		AnimationId id;
+		float start;
+		float duration;
+	};
+
+	void Append(const Timeline& timeline, float start);
+
+	std::vector<Step> m_steps;
+	float m_last = 0.0f;
+	float m_end = 0.0f;
+
+};
+
+// Stop of a keyframe track. `time` is a fraction of the instance duration and
+// `easing` shapes the segment that starts at this key.
+struct Keyframe {
+	float time = 0.0f;
+	float value = 0.0f;
+	AnimationEasing easing = EASE_LINEAR;
+};
+
+// One step of a compiled timeline, in progress of the whole timeline.
+struct _TimelineEntry {
+	float start = 0.0f;
+	float end = 0.0f;
+	Animation* animation = nullptr;
 };
 
 class Animation {
 
 public:
 
-	Animation(AnimationEvents events);
+	Animation(AnimationId id, AnimationEvents events, AnimationEasing easing, std::pmr::memory_resource* resource);
 	~Animation() = default;
 
+	AnimationId id = { };
 	AnimationEvents events = { };
+	AnimationEasing easing = EASE_LINEAR;
+
+	size_t instance_count = 0;
+	bool removed = false;
+
+	std::pmr::vector<float> batch_progress;
+	std::pmr::vector<void*> batch_objs;
+
+	// Compiled timeline, sorted by start. reach[k] is the latest end among the
+	// first k + 1 entries, so both ends of a time range are found by binary search.
+	std::pmr::vector<_TimelineEntry> timeline;
+	std::pmr::vector<float> timeline_reach;
+
+	// Keyframe track: onUpdate receives the sampled value instead of progress.
+	std::pmr::vector<float> key_times;
+	std::pmr::vector<float> key_values;
+	std::pmr::vector<AnimationEasing> key_easing;
+
+	// EASE_CUBIC_BEZIER sampled at BEZIER_SAMPLES + 1 evenly spaced progress
+	// values, looked up with linear interpolation.
+	static constexpr size_t BEZIER_SAMPLES = 256;
+	std::pmr::vector<float> bezier;
+
+	// Easing of the template, resolving EASE_CUBIC_BEZIER to its table.
+	float ease(AnimationEasing easing, float t) const;
 
 };
 
-class AnimationHandler {
+// Generational registry of templates. Templates live in a deque indexed by
+// slot, so they never move while instances point at them. Removed slots are
+// recycled under a new generation, so a stale AnimationId no longer resolves.
+class _AnimationRegistry {
 
 public:
-	static const AnimationId CreateAnimation(AnimationEvents events);
-	static InstanceId AttachAnimation(AnimationId id, void* obj, float duration, size_t repeat, AnimationEvents events);
-	static void UpdateAnimations(float dt);
 
-	static bool HasAnimation(AnimationId id);
-	static void RemoveAnimation(AnimationId id);
-	static void ClearAnimations();
+	_AnimationRegistry(std::pmr::memory_resource* resource) : m_index(resource), m_animations(resource) { }
 
-	static void Pause(InstanceId i_id);
-	static void Stop(InstanceId id);
-	static void Continue(InstanceId id);
-	static void Restart(InstanceId id);
+	AnimationId insert(const AnimationEvents& events, AnimationEasing easing);
+	void erase(AnimationId id);
+
+	Animation* get(AnimationId id) { return m_index.is_valid(id.handle) ? &m_animations[id.handle.slot_index] : nullptr; }
+
+	size_t size() const { return m_index.size(); }
+	AnimationId get_handle_at(size_t index) const { return { m_index.get_handle_at(index) }; }
 
 private:
 
-	static size_t s_animation_count;
-	static std::unordered_map<AnimationId, std::unique_ptr<Animation>> s_animations;
+	_SlotIndex m_index;
+	std::pmr::deque<Animation> m_animations;
 
-	static _SlotMap<AnimationInstance> s_instances;
+};
 
+// Deleter for objects placed in a memory_resource by _MakeOwned. It keeps the
+// allocated size, so an owner typed as a base class releases the right block.
+struct _ResourceDelete {
+	std::pmr::memory_resource* resource = nullptr;
+	size_t size = 0;
+	size_t align = 0;
+
+	template <typename T>
+	void operator()(T* object) const {
+		object->~T();
+		resource->deallocate(object, size, align);
+	}
 };
 
-#ifdef ANIM_NAMESPACE
+template <typename T>
+using _Owned = std::unique_ptr<T, _ResourceDelete>;
+
+template <typename T, typename... Args>
+_Owned<T> _MakeOwned(std::pmr::memory_resource* resource, Args&&... args) {
+	void* memory = resource->allocate(sizeof(T), alignof(T));
+	try {
+		return _Owned<T>(::new (memory) T(std::forward<Args>(args)...), { resource, sizeof(T), alignof(T) });
+	} catch (...) {
+		resource->deallocate(memory, sizeof(T), alignof(T));
+		throw;
+	}
 }
-#endif
 
-#ifdef ANIMATE_HPP_IMPLEMENTATION
+// Forwards to an upstream resource and counts the allocations made through it.
+class _CountingResource : public std::pmr::memory_resource {
 
-#ifdef ANIM_NAMESPACE
-namespace Anim {
-#endif
+public:
 
-Animation::Animation(AnimationEvents events) {
-	this->events = events;
-}
+	_CountingResource(std::pmr::memory_resource* upstream) : m_upstream(upstream) { }
 
-const AnimationId AnimationHandler::CreateAnimation(AnimationEvents events) {
-	s_animations[s_animation_count] = std::make_unique<Animation>(events);
-	return s_animation_count++;
-}
+	size_t count() const { return m_count.load(std::memory_order_relaxed); }
 
-InstanceId AnimationHandler::AttachAnimation(AnimationId id, void* obj, float duration, size_t repeat, AnimationEvents events) {
-	
-	auto de = s_animations.at(id)->events;
+private:
 
-	AnimationInstance instance;
-	
-	instance.obj = obj;
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		m_count.fetch_add(1, std::memory_order_relaxed);
+		return m_upstream->allocate(bytes, alignment);
+	}
 
-	instance.events.onStart = events.onStart ? events.onStart : de.onStart;
-	instance.events.onEachRepeatStart = events.onEachRepeatStart ? events.onEachRepeatStart : de.onEachRepeatStart;
-	instance.events.onUpdate = events.onUpdate ? events.onUpdate : de.onUpdate;
-	instance.events.onEachRepeatEnd = events.onEachRepeatEnd ? events.onEachRepeatEnd : de.onEachRepeatEnd;
-	instance.events.onEnd = events.onEnd ? events.onEnd : de.onEnd;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+		m_upstream->deallocate(p, bytes, alignment);
+	}
 
-	instance.duration = duration;
-	instance.repeat = repeat;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+		return this == &other;
+	}
 
-	return s_instances.insert(instance);
-}
+	std::pmr::memory_resource* m_upstream = nullptr;
+	std::atomic<size_t> m_count = { 0 };
 
-void AnimationHandler::UpdateAnimations(float dt) {
-	for (size_t i = 0; i < s_instances.size(); ) {
+};
 
-		auto& instance = s_instances[i];
+class _AnimationPoolBase {
 
-		auto& events = instance.events;
+public:
 
-		if (instance.state == ANIM_PAUSED) { ++i; continue;}
+	virtual ~_AnimationPoolBase() = default;
+	virtual void update(float dt) = 0;
 
-		if (instance.state == ANIM_STOPPING) {
-			if (events.onEnd) events.onEnd();
-			s_instances.erase(s_instances.get_handle_at(i));
-			continue;
+};
+
+// Handle and timing columns shared by the typed and tween pools. Derived pools
+// keep their payload in parallel columns and drop them in erase_payload().
+class _TimedPool : public _AnimationPoolBase {
+
+public:
+
+	_TimedPool(std::pmr::memory_resource* resource)
+		: time(resource), duration(resource), state(resource), easing(resource), repeat(resource), repeat_count(resource),
+		m_progress(resource), m_index(resource), m_pending(resource) { }
+
+	bool is_valid(InstanceId id) const { return m_index.is_valid(id); }
+
+	void reserve(size_t capacity) {
+		m_index.reserve(capacity);
+		time.reserve(capacity);
+		duration.reserve(capacity);
+		state.reserve(capacity);
+		easing.reserve(capacity);
+		repeat.reserve(capacity);
+		repeat_count.reserve(capacity);
+		m_progress.reserve(capacity);
+		reserve_payload(capacity);
+	}
+
+	void pause(InstanceId id) { control(id, CONTROL_PAUSE); }
+	void resume(InstanceId id) { control(id, CONTROL_CONTINUE); }
+	void stop(InstanceId id) { control(id, CONTROL_STOP); }
+	void restart(InstanceId id) { control(id, CONTROL_RESTART); }
+
+	void erase(InstanceId id) {
+		if (!m_index.is_valid(id)) return;
+
+		park(m_index.index_of(id));
+		uint32_t index = m_index.erase(id);
+
+		_SwapRemove(time, index);
+		_SwapRemove(duration, index);
+		_SwapRemove(state, index);
+		_SwapRemove(easing, index);
+		_SwapRemove(repeat, index);
+		_SwapRemove(repeat_count, index);
+
+		erase_payload(index);
+	}
+
+	std::pmr::vector<float> time;
+	std::pmr::vector<float> duration;
+	std::pmr::vector<AnimationState> state;
+	std::pmr::vector<AnimationEasing> easing;
+	std::pmr::vector<size_t> repeat;
+	std::pmr::vector<size_t> repeat_count;
+
+protected:
+
+	virtual void erase_payload(uint32_t index) = 0;
+	virtual void swap_payload(uint32_t a, uint32_t b) = 0;
+	virtual void reserve_payload(size_t capacity) = 0;
+
+	// Called once the derived pool has pushed its payload columns.
+	InstanceId insert_timing(float length, size_t repeats, AnimationEasing ease) {
+		InstanceId id = m_index.insert();
+		time.push_back(0.0f);
+		duration.push_back(length);
+		state.push_back(ANIM_RUNNING);
+		easing.push_back(ease);
+		repeat.push_back(repeats);
+		repeat_count.push_back(0);
+		unpark(m_index.index_of(id));
+		return id;
+	}
+
+	// Advances running entries and leaves their eased progress in m_progress.
+	// Paused entries are parked past active() and not visited.
+	void advance(float dt) {
+
+		m_updating = true;
+
+		size_t count = m_index.active();
+
+		float* t = time.data();
+		const float* d = duration.data();
+
+		for (size_t i = 0; i < count; ++i) {
+			float next = t[i] + dt;
+			t[i] = next < d[i] ? next : d[i];
 		}
 
-		instance.time += dt;
-		instance.time = instance.time > instance.duration ? instance.duration : instance.time;
-		
-		if (instance.state == ANIM_STARTING) {
-			if (instance.events.onStart) instance.events.onStart();
-			if (events.onEachRepeatStart) events.onEachRepeatStart(instance.obj);
-			instance.state = ANIM_RUNNING;
+		m_progress.resize(count);
+		float* p = m_progress.data();
+
+		for (size_t i = 0; i < count; ++i) p[i] = t[i] / d[i];
+
+		for (size_t i = 0; i < count; ) {
+			size_t run = i + 1;
+			while (run < count && easing[run] == easing[i]) ++run;
+			if (easing[i] != EASE_LINEAR) EaseBatch(easing[i], p + i, p + i, run - i);
+			i = run;
 		}
+	}
 
-		if (events.onUpdate) events.onUpdate(instance.time / instance.duration, instance.obj);
+	// Rewinds entries that completed a cycle, erases finished ones and applies
+	// the controls issued during the update.
+	void end_cycles() {
+		for (size_t i = m_index.active(); i-- > 0; ) {
 
-		if (instance.time == instance.duration) {
-			if (instance.repeat != 0) instance.repeat_count++;
-			
-			if (events.onEachRepeatEnd) events.onEachRepeatEnd(instance.obj);
-			instance.time = 0.0f;
+			if (time[i] != duration[i]) continue;
 
-			if (instance.repeat > 0 && instance.repeat_count == instance.repeat) {
-				instance.state = ANIM_FINISHED;
-				if (events.onEnd) events.onEnd();
-				s_instances.erase(s_instances.get_handle_at(i));
-			} else {
-				if (events.onEachRepeatStart) events.onEachRepeatStart(instance.obj);
-				++i;
-			}
-		} else {
-			++i;
+			time[i] = 0.0f;
+			if (repeat[i] != 0 && ++repeat_count[i] == repeat[i]) erase(m_index.get_handle_at(i));
 		}
+
+		m_updating = false;
+
+		for (const auto& pending : m_pending) control(pending.first, pending.second);
+		m_pending.clear();
 	}
-}
 
-bool AnimationHandler::HasAnimation(AnimationId id) {
-	return s_animations.find(id) != s_animations.end();
-}
+	std::pmr::vector<float> m_progress;
+	_SlotIndex m_index;
 
-void AnimationHandler::RemoveAnimation(AnimationId id) {
-	s_animations.erase(id);
-}
+private:
 
-void AnimationHandler::ClearAnimations() {
-	s_animations.clear();
-}
+	enum Control : uint8_t {
+		CONTROL_PAUSE = 0,
+		CONTROL_CONTINUE,
+		CONTROL_STOP,
+		CONTROL_RESTART,
+	};
 
-void AnimationHandler::Pause(InstanceId id) {
-	if (auto* inst = s_instances.get(id)) inst->state = ANIM_PAUSED;
-}
+	// Controls issued from inside update() would move entries under the loop,
+	// so they are queued until end_cycles().
+	void control(InstanceId id, Control type) {
 
-void AnimationHandler::Stop(InstanceId id) {
-	if (auto* inst = s_instances.get(id)) inst->state = ANIM_STOPPING;
-}
+		if (!m_index.is_valid(id)) return;
 
-void AnimationHandler::Continue(InstanceId id) {
-	if (auto* inst = s_instances.get(id)) inst->state = ANIM_RUNNING;
-}
+		if (m_updating) {
+			m_pending.push_back({ id, type });
+			return;
+		}
 
-void AnimationHandler::Restart(InstanceId id) {
-	if (auto* inst = s_instances.get(id)) {
-		inst->state = ANIM_STARTING;
-		inst->time = 0.0f;
-		inst->repeat_count = 0;
+		uint32_t i = m_index.index_of(id);
+
+		switch (type) {
+			case CONTROL_PAUSE:
+				i = park(i);
+				state[i] = ANIM_PAUSED;
+				break;
+			case CONTROL_CONTINUE:
+				if (state[i] != ANIM_PAUSED) break;
+				i = unpark(i);
+				state[i] = ANIM_RUNNING;
+				break;
+			case CONTROL_STOP:
+				erase(id);
+				break;
+			case CONTROL_RESTART:
+				i = unpark(i);
+				state[i] = ANIM_RUNNING;
+				time[i] = 0.0f;
+				repeat_count[i] = 0;
+				break;
+		}
 	}
-}
 
-size_t AnimationHandler::s_animation_count = 0;
-std::unordered_map<AnimationId, std::unique_ptr<Animation>> AnimationHandler::s_animations = { };
+	uint32_t park(uint32_t index) {
+		uint32_t moved = m_index.park(index);
+		swap_columns(index, moved);
+		return moved;
+	}
+
+	uint32_t unpark(uint32_t index) {
+		uint32_t moved = m_index.unpark(index);
+		swap_columns(index, moved);
+		return moved;
+	}
+
+	void swap_columns(uint32_t a, uint32_t b) {
+		if (a == b) return;
+		std::swap(time[a], time[b]);
+		std::swap(duration[a], duration[b]);
+		std::swap(state[a], state[b]);
+		std::swap(easing[a], easing[b]);
+		std::swap(repeat[a], repeat[b]);
+		std::swap(repeat_count[a], repeat_count[b]);
+		swap_payload(a, b);
+	}
+
+	std::pmr::vector<std::pair<InstanceId, Control>> m_pending;
+	bool m_updating = false;
+
+};
+
+// Homogeneous pool for one TypedAnimation. The object type and the update
+// functor are template parameters, so the per-frame loop is monomorphized and
+// the functor call can be inlined: no void*, no indirect call per instance.
+template <typename T, typename UpdateFn>
+class _TypedPool : public _TimedPool {
+
+public:
+
+	_TypedPool(std::pmr::memory_resource* resource, UpdateFn update, AnimationEasing easing)
+		: _TimedPool(resource), obj(resource), m_update(std::move(update)), m_easing(easing) { }
+
+	InstanceId insert(T* object, float length, size_t repeats) {
+		obj.push_back(object);
+		return insert_timing(length, repeats, m_easing);
+	}
+
+	void update(float dt) override {
+
+		advance(dt);
+
+		for (size_t i = 0; i < m_progress.size(); ++i) m_update(m_progress[i], *obj[i]);
+
+		end_cycles();
+	}
+
+	std::pmr::vector<T*> obj;
+
+private:
+
+	void erase_payload(uint32_t index) override {
+		_SwapRemove(obj, index);
+	}
+
+	void swap_payload(uint32_t a, uint32_t b) override {
+		std::swap(obj[a], obj[b]);
+	}
+
+	void reserve_payload(size_t capacity) override {
+		obj.reserve(capacity);
+	}
+
+	UpdateFn m_update;
+	AnimationEasing m_easing = EASE_LINEAR;
+
+};
+
+// Handle to a typed animation template created with
+// AnimationHandler::CreateTypedAnimation<T>(fn). fn is called as fn(progress, T&).
+// Typed instances only run the update functor; they have no lifecycle events.
+template <typename T, typename UpdateFn>
+class TypedAnimation {
+
+public:
+
+	TypedAnimation(_TypedPool<T, UpdateFn>* pool) : m_pool(pool) { }
+
+	InstanceId Attach(T* obj, float duration, size_t repeat) {
+		return m_pool->insert(obj, duration, repeat);
+	}
+
+	void Pause(InstanceId id) { m_pool->pause(id); }
+	void Stop(InstanceId id) { m_pool->stop(id); }
+	void Continue(InstanceId id) { m_pool->resume(id); }
+	void Restart(InstanceId id) { m_pool->restart(id); }
+	void Reserve(size_t capacity) { m_pool->reserve(capacity); }
+
+	bool IsValid(InstanceId id) const { return m_pool->is_valid(id); }
+
+private:
+
+	_TypedPool<T, UpdateFn>* m_pool = nullptr;
+
+};
+
+// Interpolation used by tweens. Specialize Lerp for a type to make it tweenable.
+template <typename T>
+struct _TweenTraits;
+
+template <>
+struct _TweenTraits<float> {
+	static float Lerp(float a, float b, float t) { return a + (b - a) * t; }
+};
+
+#if defined(RAYLIB_H) || defined(RAYMATH_H)
+
+template <>
+struct _TweenTraits<Vector2> {
+	static Vector2 Lerp(Vector2 a, Vector2 b, float t) {
+		return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+	}
+};
+
+template <>
+struct _TweenTraits<Vector3> {
+	static Vector3 Lerp(Vector3 a, Vector3 b, float t) {
+		return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t };
+	}
+};
+
+#endif
+
+#if defined(RAYMATH_H)
+
+template <>
+struct _TweenTraits<Quaternion> {
+	static Quaternion Lerp(Quaternion a, Quaternion b, float t) { return QuaternionSlerp(a, b, t); }
+};
+
+#endif
+
+#if defined(RAYLIB_H)
+
+template <>
+struct _TweenTraits<Color> {
+	static unsigned char Channel(unsigned char a, unsigned char b, float t) {
+		float value = a + (b - a) * t + 0.5f;
+		return (unsigned char)(value < 0.0f ? 0.0f : value > 255.0f ? 255.0f : value);
+	}
+
+	static Color Lerp(Color a, Color b, float t) {
+		return { Channel(a.r, b.r, t), Channel(a.g, b.g, t), Channel(a.b, b.b, t), Channel(a.a, b.a, t) };
+	}
+};
+
+template <>
+struct _TweenTraits<Rectangle> {
+	static Rectangle Lerp(Rectangle a, Rectangle b, float t) {
+		return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.width + (b.width - a.width) * t, a.height + (b.height - a.height) * t };
+	}
+};
+
+#endif
+
+// One pool per tweened type: target pointers and start/end values live in
+// dense arrays next to the timing columns and are written by a plain loop.
+template <typename T>
+class _TweenPool : public _TimedPool {
+
+public:
+
+	_TweenPool(std::pmr::memory_resource* resource)
+		: _TimedPool(resource), target(resource), start(resource), end(resource), m_curve_of(resource), m_curves(resource) { }
+
+	InstanceId insert(T* object, T from, T to, float length, AnimationEasing ease, size_t repeats) {
+		target.push_back(object);
+		start.push_back(from);
+		end.push_back(to);
+		m_curve_of.push_back(NO_CURVE);
+		return insert_timing(length, repeats, ease);
+	}
+
+	// Restarts the tween from its current value towards `to`, in the same slot.
+	// The new cycle is a cubic Bezier whose first control point carries the
+	// current velocity, so neither the value nor its velocity jumps; it ends
+	// with the slope the tween's easing has at 1. The control points are built
+	// with Lerp alone, so every tweenable type supports it.
+	void retarget(InstanceId id, const T& to) {
+		if (!m_index.is_valid(id)) return;
+
+		uint32_t i = m_index.index_of(id);
+		float u = time[i] / duration[i];
+		Curve* curve = m_curve_of[i] != NO_CURVE ? &m_curves[m_curve_of[i]] : nullptr;
+
+		T current, lead;
+
+		if (curve) {
+			// Velocity of a curve is 3 * (q1 - q0) / duration at u.
+			T q0, q1;
+			split_curve(*curve, i, u, q0, q1);
+			current = _TweenTraits<T>::Lerp(q0, q1, u);
+			lead = _TweenTraits<T>::Lerp(q0, q1, u + 1.0f);
+		} else {
+			float q = Ease(easing[i], u);
+			current = _TweenTraits<T>::Lerp(start[i], end[i], q);
+			lead = _TweenTraits<T>::Lerp(start[i], end[i], q + Slope(easing[i], u) / 3.0f);
+			m_curve_of[i] = (uint32_t)m_curves.size();
+			curve = &m_curves.emplace_back();
+			curve->row = i;
+		}
+
+		curve->first = lead;
+		curve->second = _TweenTraits<T>::Lerp(current, to, 1.0f - Slope(easing[i], 1.0f) / 3.0f);
+
+		start[i] = current;
+		end[i] = to;
+		time[i] = 0.0f;
+	}
+
+	void update(float dt) override {
+
+		advance(dt);
+
+		for (size_t i = 0; i < m_progress.size(); ++i) *target[i] = _TweenTraits<T>::Lerp(start[i], end[i], m_progress[i]);
+
+		if (!m_curves.empty()) update_curves();
+
+		end_cycles();
+	}
+
+	std::pmr::vector<T*> target;
+	std::pmr::vector<T> start;
+	std::pmr::vector<T> end;
+
+private:
+
+	static constexpr uint32_t NO_CURVE = UINT32_MAX;
+
+	// Inner control points of a retargeted cycle, which runs from start to end
+	// over linear time. `row` and m_curve_of link a curve and its tween both
+	// ways, and move with the row in swap_payload and erase_payload.
+	struct Curve {
+		uint32_t row;
+		T first;
+		T second;
+	};
+
+	void erase_curve(uint32_t k) {
+		m_curve_of[m_curves[k].row] = NO_CURVE;
+		if (k + 1 < m_curves.size()) {
+			m_curves[k] = m_curves.back();
+			m_curve_of[m_curves[k].row] = k;
+		}
+		m_curves.pop_back();
+	}
+
+	// Derivative of an easing at u, by central difference.
+	static float Slope(AnimationEasing ease, float u) {
+		const float h = 1.0f / 1024.0f;
+		float a = std::max(u - h, 0.0f);
+		float b = std::min(u + h, 1.0f);
+		return (Ease(ease, b) - Ease(ease, a)) / (b - a);
+	}
+
+	// De Casteljau down to the last two points; the curve is at Lerp(q0, q1, u).
+	void split_curve(const Curve& curve, uint32_t i, float u, T& q0, T& q1) const {
+		T a = _TweenTraits<T>::Lerp(start[i], curve.first, u);
+		T b = _TweenTraits<T>::Lerp(curve.first, curve.second, u);
+		T c = _TweenTraits<T>::Lerp(curve.second, end[i], u);
+		q0 = _TweenTraits<T>::Lerp(a, b, u);
+		q1 = _TweenTraits<T>::Lerp(b, c, u);
+	}
+
+	// Curves are sparse, so they are applied over the plain loop's output and
+	// dropped once their cycle ends.
+	void update_curves() {
+		for (uint32_t k = 0; k < m_curves.size(); ) {
+			Curve& curve = m_curves[k];
+			uint32_t i = curve.row;
+
+			// Paused: keep the curve for when it resumes.
+			if (i >= m_index.active()) {
+				++k;
+				continue;
+			}
+
+			float u = time[i] / duration[i];
+			T q0, q1;
+			split_curve(curve, i, u, q0, q1);
+			*target[i] = _TweenTraits<T>::Lerp(q0, q1, u);
+
+			if (time[i] == duration[i]) {
+				erase_curve(k);
+			} else {
+				++k;
+			}
+		}
+	}
+
+	void erase_payload(uint32_t index) override {
+		if (m_curve_of[index] != NO_CURVE) erase_curve(m_curve_of[index]);
+
+		_SwapRemove(target, index);
+		_SwapRemove(start, index);
+		_SwapRemove(end, index);
+		_SwapRemove(m_curve_of, index);
+
+		if (index < m_curve_of.size() && m_curve_of[index] != NO_CURVE) m_curves[m_curve_of[index]].row = index;
+	}
+
+	void swap_payload(uint32_t a, uint32_t b) override {
+		std::swap(target[a], target[b]);
+		std::swap(start[a], start[b]);
+		std::swap(end[a], end[b]);
+		std::swap(m_curve_of[a], m_curve_of[b]);
+
+		if (m_curve_of[a] != NO_CURVE) m_curves[m_curve_of[a]].row = a;
+		if (m_curve_of[b] != NO_CURVE) m_curves[m_curve_of[b]].row = b;
+	}
+
+	void reserve_payload(size_t capacity) override {
+		target.reserve(capacity);
+		start.reserve(capacity);
+		end.reserve(capacity);
+		m_curve_of.reserve(capacity);
+	}
+
+	// Index into m_curves of each row's curve, or NO_CURVE.
+	std::pmr::vector<uint32_t> m_curve_of;
+	std::pmr::vector<Curve> m_curves;
+
+};
+
+template <typename T>
+struct TweenId {
+	InstanceId id = { };
+};
+
+// A spring comes to rest once every component is within `precision` of its
+// goal and too slow to swing further than that (|v| / omega <= precision).
+struct SpringParams {
+	float stiffness = 170.0f;
+	float damping = 26.0f;
+	float mass = 1.0f;
+	float precision = 0.001f;
+};
+
+// Number of float components a spring over T integrates. T is read and written
+// as that many packed floats.
+template <typename T>
+struct _SpringTraits;
+
+template <>
+struct _SpringTraits<float> {
+	static constexpr size_t CHANNELS = 1;
+};
+
+#if defined(RAYLIB_H) || defined(RAYMATH_H)
+
+template <>
+struct _SpringTraits<Vector2> {
+	static constexpr size_t CHANNELS = 2;
+};
+
+template <>
+struct _SpringTraits<Vector3> {
+	static constexpr size_t CHANNELS = 3;
+};
+
+template <>
+struct _SpringTraits<Vector4> {
+	static constexpr size_t CHANNELS = 4;
+};
+
+#endif
+
+#if defined(RAYLIB_H)
+
+template <>
+struct _SpringTraits<Rectangle> {
+	static constexpr size_t CHANNELS = 4;
+};
+
+#endif
+
+// One pool per sprung type. Springs have no duration: each component is a lane
+// in packed position/velocity/goal/coefficient arrays, integrated together with
+// semi-implicit Euler. Springs at rest are parked past active() until their goal
+// changes, so the integration loop skips them (see _TimingWheel on parking).
+template <typename T>
+class _SpringPool : public _AnimationPoolBase {
+
+public:
+
+	static constexpr size_t N = _SpringTraits<T>::CHANNELS;
+	static_assert(sizeof(T) == N * sizeof(float), "springs read and write T as packed floats");
+
+	// Longest integration step; longer frames are split into equal substeps.
+	// At most MAX_STEPS are taken per update: the part of a frame past
+	// MAX_STEP * MAX_STEPS (a debugger pause, an alt-tab, a large time scale)
+	// is dropped, so a stalled frame slows the springs down instead of costing
+	// an unbounded number of substeps.
+	static constexpr float MAX_STEP = 1.0f / 120.0f;
+	static constexpr int MAX_STEPS = 8;
+
+	_SpringPool(std::pmr::memory_resource* resource)
+		: target(resource), precision(resource), on_rest(resource), position(resource), velocity(resource), goal(resource),
+		stiffness(resource), damping(resource), inverse_mass(resource), m_index(resource), m_rested(resource) { }
+
+	bool is_valid(InstanceId id) const { return m_index.is_valid(id); }
+
+	void reserve(size_t capacity) {
+		m_index.reserve(capacity);
+		target.reserve(capacity);
+		precision.reserve(capacity);
+		on_rest.reserve(capacity);
+		for_each_lane([capacity](auto& column) { column.reserve(capacity * N); });
+	}
+
+	InstanceId insert(T* object, const T& to, const SpringParams& params, AnimationOnEnd rest) {
+		InstanceId id = m_index.insert();
+
+		target.push_back(object);
+		precision.push_back(params.precision);
+		on_rest.push_back(std::move(rest));
+
+		float from[N], aim[N];
+		std::memcpy(from, object, sizeof(T));
+		std::memcpy(aim, &to, sizeof(T));
+
+		for (size_t c = 0; c < N; ++c) {
+			position.push_back(from[c]);
+			velocity.push_back(0.0f);
+			goal.push_back(aim[c]);
+			stiffness.push_back(params.stiffness);
+			damping.push_back(params.damping);
+			inverse_mass.push_back(params.mass > 0.0f ? 1.0f / params.mass : 1.0f);
+		}
+
+		unpark(m_index.index_of(id));
+		return id;
+	}
+
+	// Moves the goal and wakes the spring; position and velocity carry over.
+	void retarget(InstanceId id, const T& to) {
+		if (!m_index.is_valid(id)) return;
+
+		uint32_t i = m_index.index_of(id);
+		std::memcpy(&goal[i * N], &to, sizeof(T));
+		unpark(i);
+	}
+
+	void erase(InstanceId id) {
+		if (!m_index.is_valid(id)) return;
+
+		park(m_index.index_of(id));
+		uint32_t index = m_index.erase(id);
+
+		_SwapRemove(target, index);
+		_SwapRemove(precision, index);
+		_SwapRemove(on_rest, index);
+
+		size_t last = target.size();
+		for_each_lane([index, last](auto& column) {
+			if (index != last) std::copy_n(column.begin() + last * N, N, column.begin() + index * N);
+			column.resize(last * N);
+		});
+	}
+
+	void update(float dt) override {
+
+		size_t count = m_index.active();
+		if (count == 0 || !(dt > 0.0f)) return;
+
+		size_t lanes = count * N;
+		dt = std::min(dt, MAX_STEP * MAX_STEPS);
+		int steps = std::max((int)std::ceil(dt / MAX_STEP), 1);
+		float h = dt / (float)steps;
+
+		float* x = position.data();
+		float* v = velocity.data();
+		const float* g = goal.data();
+		const float* k = stiffness.data();
+		const float* c = damping.data();
+		const float* m = inverse_mass.data();
+
+		for (int step = 0; step < steps; ++step) {
+			for (size_t i = 0; i < lanes; ++i) {
+				float a = (k[i] * (g[i] - x[i]) - c[i] * v[i]) * m[i];
+				v[i] += a * h;
+				x[i] += v[i] * h;
+			}
+		}
+
+		// Backwards, so parking only swaps in springs that were already visited.
+		for (size_t j = count; j-- > 0; ) {
+			float e = precision[j];
+			bool rest = true;
+
+			for (size_t l = j * N; l < j * N + N; ++l) {
+				float offset = g[l] - x[l];
+				if (offset > e || offset < -e || v[l] * v[l] > e * e * k[l] * m[l]) rest = false;
+			}
+
+			if (rest) {
+				std::copy_n(g + j * N, N, x + j * N);
+				std::fill_n(v + j * N, N, 0.0f);
+			}
+
+			std::memcpy(target[j], x + j * N, sizeof(T));
+
+			if (rest) {
+				m_rested.push_back(m_index.get_handle_at(j));
+				park((uint32_t)j);
+			}
+		}
+
+		// Callbacks may retarget, stop or add springs, so they run after the loops.
+		for (size_t r = 0; r < m_rested.size(); ++r) {
+			if (!m_index.is_valid(m_rested[r])) continue;
+			AnimationOnEnd callback = on_rest[m_index.index_of(m_rested[r])];
+			if (callback) callback();
+		}
+
+		m_rested.clear();
+	}
+
+	std::pmr::vector<T*> target;
+	std::pmr::vector<float> precision;
+	std::pmr::vector<AnimationOnEnd> on_rest;
+
+	// N lanes per spring.
+	std::pmr::vector<float> position;
+	std::pmr::vector<float> velocity;
+	std::pmr::vector<float> goal;
+	std::pmr::vector<float> stiffness;
+	std::pmr::vector<float> damping;
+	std::pmr::vector<float> inverse_mass;
+
+private:
+
+	template <typename F>
+	void for_each_lane(F f) {
+		f(position); f(velocity); f(goal); f(stiffness); f(damping); f(inverse_mass);
+	}
+
+	uint32_t park(uint32_t index) {
+		uint32_t moved = m_index.park(index);
+		swap_springs(index, moved);
+		return moved;
+	}
+
+	uint32_t unpark(uint32_t index) {
+		uint32_t moved = m_index.unpark(index);
+		swap_springs(index, moved);
+		return moved;
+	}
+
+	void swap_springs(uint32_t a, uint32_t b) {
+		if (a == b) return;
+		std::swap(target[a], target[b]);
+		std::swap(precision[a], precision[b]);
+		std::swap(on_rest[a], on_rest[b]);
+		for_each_lane([a, b](auto& column) { std::swap_ranges(column.begin() + a * N, column.begin() + a * N + N, column.begin() + b * N); });
+	}
+
+	_SlotIndex m_index;
+	std::pmr::vector<InstanceId> m_rested;
+
+};
+
+template <typename T>
+struct SpringId {
+	InstanceId id = { };
+};
+
+inline size_t _NextTypeIndex() {
+	static std::atomic<size_t> next = { 0 };
+	return next++;
+}
+
+template <typename T>
+size_t _TypeIndex() {
+	static const size_t index = _NextTypeIndex();
+	return index;
+}
+
+// Fixed set of threads running batches of indexed tasks. Tasks are dealt round
+// robin into per-worker deques; a worker pops from the back of its own deque
+// and steals from the front of the others once it runs dry. The calling thread
+// takes part as worker 0. The pool, its queues and its thread handles live in
+// the owning world's resource; only the threads' own start-up state goes
+// through the global heap, as std::thread does not take an allocator.
+class _WorkerPool {
+
+public:
+
+	typedef void (*Task)(void* context, size_t task, size_t worker);
+
+	_WorkerPool(size_t threads, std::pmr::memory_resource* resource);
+	~_WorkerPool();
+
+	size_t size() const { return m_queues.size(); }
+	void run(size_t tasks, Task task, void* context);
+
+private:
+
+	// The owner pops from the back, thieves take from `head`. Storage is kept
+	// between runs so a steady workload does not allocate.
+	// `generation` is the run the tasks belong to. A worker that wakes late
+	// still holds the previous run's task function, so it only takes tasks
+	// queued for the run it woke for.
+	struct Queue {
+		Queue(std::pmr::memory_resource* resource) : tasks(resource) { }
+
+		std::mutex mutex;
+		std::pmr::vector<size_t> tasks;
+		size_t head = 0;
+		size_t generation = 0;
+	};
+
+	void work(size_t worker, size_t generation, Task task, void* context);
+	bool pop(size_t worker, size_t generation, size_t& task);
+	void thread_main(size_t worker);
+
+	std::pmr::vector<_Owned<Queue>> m_queues;
+	std::pmr::vector<std::thread> m_threads;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+
+	Task m_task = nullptr;
+	void* m_context = nullptr;
+	size_t m_generation = 0;
+	size_t m_busy = 0;
+	std::atomic<size_t> m_remaining = { 0 };
+	bool m_stop = false;
+
+};
+
+struct _AnimationCommand {
+
+	enum Type : uint8_t {
+		CMD_ATTACH = 0,
+		CMD_RELEASE,
+		CMD_PAUSE,
+		CMD_STOP,
+		CMD_CONTINUE,
+		CMD_RESTART,
+		CMD_SET_EASING,
+		CMD_SLEEP,
+		CMD_SET_TAGS,
+		CMD_SET_SPEED,
+		CMD_SET_GROUP,
+		CMD_SET_DIRECTION,
+
+		// World-wide, no instance id.
+		CMD_SET_TIME_SCALE,
+		CMD_SET_GROUP_SCALE,
+		CMD_FREEZE,
+		CMD_UNFREEZE,
+	};
+
+	Type type = CMD_RELEASE;
+	InstanceId id = { };
+	uint32_t index = UINT32_MAX;
+	uint32_t arg = 0;
+	float value = 0.0f;
+
+	// Non-zero: applies to every instance sharing a tag bit instead of `id`.
+	uint32_t tags = 0;
+
+	AnimationInstance instance = { };
+	uint32_t events = UINT32_MAX;
+};
+
+// Per-worker state of one UpdateAnimations call: deferred commands, instances
+// that reached the end of a cycle and the slice of every onUpdateBatch gathered
+// by that worker. Instances are recorded by dense index while workers run, as
+// slots may be reserved concurrently; dense indices stay put until the flush.
+struct _WorkerScratch {
+	_WorkerScratch(std::pmr::memory_resource* resource)
+		: commands(resource), events(resource), cycle_ends(resource), progress(resource),
+		batch_animations(resource), batch_progress(resource), batch_objs(resource) { }
+
+	std::pmr::vector<_AnimationCommand> commands;
+	std::pmr::vector<AnimationEvents> events;
+	std::pmr::vector<uint32_t> cycle_ends;
+	std::pmr::vector<float> progress;
+
+	std::pmr::vector<Animation*> batch_animations;
+	std::pmr::vector<float> batch_progress;
+	std::pmr::vector<void*> batch_objs;
+};
+
+struct _WheelEntry {
+	InstanceId id = { };
+	uint64_t tick = 0;
+};
+
+// Hierarchical timing wheel: four levels of 256 slots, level 0 holding one
+// tick per slot. Scheduling is O(1); advancing costs one slot per elapsed tick
+// plus an occasional cascade of a higher level slot into the lower ones.
+// Slots are intrusive lists over a pooled node array, so once the pool has
+// grown to the peak number of waiting entries nothing allocates.
+//
+// Parking: paused, frozen and waiting instances are moved past active(), so the
+// update loop neither reads nor writes them. A waiting instance still holds a
+// node here until it wakes, and each frame advances the wheel and runs the wake
+// pass over the entries that came due. Paused and frozen instances and sleeping
+// springs take no node, but each Freeze or Unfreeze call walks the active or
+// parked range once.
+class _TimingWheel {
+
+public:
+
+	_TimingWheel(std::pmr::memory_resource* resource) : m_nodes(resource) {
+		std::fill(std::begin(m_heads), std::end(m_heads), NONE);
+	}
+
+	void reserve(size_t capacity) { m_nodes.reserve(capacity); }
+
+	void schedule(InstanceId id, uint64_t tick);
+
+	// Moves every entry due at or before `now` into `due`.
+	void advance(uint64_t now, std::pmr::vector<_WheelEntry>& due);
+
+	uint64_t now() const { return m_now; }
+
+private:
+
+	static constexpr int LEVELS = 4;
+	static constexpr int BITS = 8;
+	static constexpr uint64_t SLOTS = 1 << BITS;
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+	struct Node {
+		_WheelEntry entry = { };
+		uint32_t next = NONE;
+	};
+
+	uint32_t& head(int level, uint64_t tick) {
+		return m_heads[level * SLOTS + ((tick >> (BITS * level)) & (SLOTS - 1))];
+	}
+
+	// Files a node due after m_now under the lowest level that spans it.
+	void link(uint32_t node);
+
+	// Hands every node of a detached slot to `due` or back to link().
+	void drain(uint32_t node, std::pmr::vector<_WheelEntry>& due);
+
+	std::pmr::vector<Node> m_nodes;
+	uint32_t m_free = NONE;
+	uint32_t m_heads[LEVELS * SLOTS];
+	uint64_t m_now = 0;
+
+};
+
+// Owns a set of animation templates, instances and typed pools. Worlds are
+// independent of each other: each one is updated on its own and destroying a
+// world frees everything it owns at once, without running any callbacks.
+class AnimationWorld {
+
+public:
+
+	// Every container of the world, including templates and typed pools, is
+	// allocated from `resource`, which must outlive the world.
+	explicit AnimationWorld(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	~AnimationWorld() = default;
+
+	AnimationWorld(const AnimationWorld&) = delete;
+	AnimationWorld& operator=(const AnimationWorld&) = delete;
+
+	const AnimationId CreateAnimation(AnimationEvents events, AnimationEasing easing = EASE_LINEAR);
+	// Solves the curve once into a lookup table shared by every instance.
+	const AnimationId CreateAnimation(AnimationEvents events, CubicBezier curve);
+
+	// Compiles `timeline` into a template that plays all of its steps from one
+	// instance: attach it with a duration of timeline.Duration() to play at the
+	// authored speed (other durations stretch it). Steps get onStart and
+	// onEachRepeatStart when entered and onEachRepeatEnd and onEnd when passed,
+	// and onUpdate in between; played in reverse, steps only get onUpdate. The
+	// step templates stay alive as long as the timeline does.
+	const AnimationId CreateTimeline(const Timeline& timeline, AnimationEvents events = { }, AnimationEasing easing = EASE_LINEAR);
+
+	// Creates a template whose onUpdate and onUpdateBatch receive the value of
+	// the track at the current progress instead of the progress itself. Keys
+	// must be sorted by time; the track holds its first and last value outside
+	// them. Each instance caches its current segment, so sampling forward in
+	// time is O(1) amortized.
+	const AnimationId CreateKeyframes(const Keyframe* keys, size_t count, AnimationEvents events, AnimationEasing easing = EASE_LINEAR);
+	const AnimationId CreateKeyframes(std::initializer_list<Keyframe> keys, AnimationEvents events, AnimationEasing easing = EASE_LINEAR) {
+		return CreateKeyframes(keys.begin(), keys.size(), events, easing);
+	}
+
+	// The instance starts after `delay` seconds and waits `repeat_delay` seconds
+	// between cycles. Waiting instances are parked on the timing wheel (see
+	// _TimingWheel for what parking skips).
+	InstanceId AttachAnimation(AnimationId id, void* obj, float duration, size_t repeat, AnimationEvents events, float delay = 0.0f, float repeat_delay = 0.0f);
+
+	// Attaches one instance per object in a single pass, with one shared or one
+	// per-object duration. Handles are written to `ids` when given; returns how
+	// many were attached (fewer than `count` only when a hard capacity is hit,
+	// the rest of `ids` is then ANIM_INVALID_INSTANCE).
+	size_t AttachAnimationBatch(AnimationId id, void* const* objs, size_t count, float duration, size_t repeat, AnimationEvents events, InstanceId* ids = nullptr);
+	size_t AttachAnimationBatch(AnimationId id, void* const* objs, size_t count, const float* durations, size_t repeat, AnimationEvents events, InstanceId* ids = nullptr);
+
+	// AttachAnimation, Pause, Stop, Continue and Restart called from callbacks
+	// during the update are queued and applied together once it finishes. The
+	// returned InstanceId is valid immediately; the instance first updates on
+	// the following frame.
+	void UpdateAnimations(float dt);
+
+	template <typename T, typename UpdateFn>
+	TypedAnimation<T, UpdateFn> CreateTypedAnimation(UpdateFn update, AnimationEasing easing = EASE_LINEAR);
+
+	// Interpolates *target from start to end, repeat times (0 loops forever).
+	// Supports float, and Vector2, Vector3, Color, Rectangle and Quaternion when
+	// raylib.h / raymath.h are included before this header.
+	template <typename T>
+	TweenId<T> Tween(T* target, T start, T end, float duration, AnimationEasing easing = EASE_LINEAR, size_t repeat = 1);
+
+	template <typename T> bool HasTween(TweenId<T> id);
+	template <typename T> void Pause(TweenId<T> id);
+	template <typename T> void Stop(TweenId<T> id);
+	template <typename T> void Continue(TweenId<T> id);
+	template <typename T> void Restart(TweenId<T> id);
+
+	// Restarts a tween from its current value towards `end`, keeping its
+	// TweenId. The new cycle starts with the velocity the tween had, so the
+	// motion bends towards `end` instead of jumping.
+	template <typename T> void Retarget(TweenId<T> id, T end);
+
+	// Drives *target towards `goal` with a damped spring, starting from the
+	// current value of *target. Springs have no duration: onEnd fires whenever
+	// the spring comes to rest, after which it sleeps until SetSpringTarget
+	// moves the goal. A spring lives until Stop. Supports float, and Vector2,
+	// Vector3, Vector4/Quaternion and Rectangle with raylib.h / raymath.h.
+	template <typename T>
+	SpringId<T> Spring(T* target, T goal, SpringParams params = { }, AnimationOnEnd onEnd = nullptr);
+	// Critically damped spring that closes most of the gap in about `smooth_time` seconds.
+	template <typename T>
+	SpringId<T> SmoothDamp(T* target, T goal, float smooth_time, AnimationOnEnd onEnd = nullptr);
+
+	template <typename T> bool HasSpring(SpringId<T> id);
+	template <typename T> void SetSpringTarget(SpringId<T> id, T goal);
+	template <typename T> void Stop(SpringId<T> id);
+
+	bool HasAnimation(AnimationId id);
+	void RemoveAnimation(AnimationId id);
+	void ClearAnimations();
+
+	void Pause(InstanceId id);
+	void Stop(InstanceId id);
+	void Continue(InstanceId id);
+	void Restart(InstanceId id);
+	void SetEasing(InstanceId id, AnimationEasing easing);
+
+	// Changing direction mid-cycle mirrors the elapsed time, so a running
+	// instance turns around from its current progress instead of jumping.
+	void SetDirection(InstanceId id, AnimationDirection direction);
+
+	// Bulk controls. The array forms touch only the listed instances; the tag
+	// forms apply in one pass over the instance pool. Tags are a bit mask set
+	// per instance; PauseAll(t) and friends affect every instance whose tags
+	// share a bit with t.
+	void Pause(const InstanceId* ids, size_t count);
+	void Stop(const InstanceId* ids, size_t count);
+	void Continue(const InstanceId* ids, size_t count);
+	void Restart(const InstanceId* ids, size_t count);
+
+	void SetTags(InstanceId id, uint32_t tags);
+	void PauseAll(uint32_t tags);
+	void StopAll(uint32_t tags);
+	void ContinueAll(uint32_t tags);
+	void RestartAll(uint32_t tags);
+
+	// Time scaling. The world scale multiplies every dt passed to
+	// UpdateAnimations, delays and tweens included. Each instance also has a
+	// speed and belongs to one of ANIM_GROUP_COUNT groups (0 by default) whose
+	// scale applies on top of the speed.
+	void SetTimeScale(float scale);
+	float GetTimeScale() const { return m_time_scale; }
+	void SetSpeed(InstanceId id, float speed);
+	void SetGroup(InstanceId id, uint32_t group);
+	void SetGroupScale(uint32_t group, float scale);
+	float GetGroupScale(uint32_t group) const { return group < ANIM_GROUP_COUNT ? m_group_scale[group] : 1.0f; }
+
+	// Freezes every group set in the `groups` bit mask. Frozen instances are
+	// parked like paused ones (see _TimingWheel). Hitstop thaws the groups again
+	// after `seconds` of unscaled time.
+	void Freeze(uint32_t groups);
+	void Unfreeze(uint32_t groups);
+	void Hitstop(uint32_t groups, float seconds);
+
+	// Splits UpdateAnimations into chunks of instances run on `workers` extra
+	// threads (0 restores the serial update). Callbacks then run concurrently
+	// and must only touch their own objects. Templates must not be created or
+	// removed during a parallel update.
+	void SetWorkerCount(size_t workers, size_t chunk_size = 4096);
+
+	// Pre-sizes storage for `instances` live instances. With hard_capacity set
+	// the storage never grows: AttachAnimation returns ANIM_INVALID_INSTANCE
+	// while that many are live.
+	void Reserve(size_t instances, bool hard_capacity = false);
+	template <typename T> void ReserveTweens(size_t count) { TweenPool<T>().reserve(count); }
+	template <typename T> void ReserveSprings(size_t count) { SpringPool<T>().reserve(count); }
+
+	// Allocations made from the world's memory resource so far. Only counted
+	// when ANIM_COUNT_ALLOCATIONS is set, which is the default in debug builds.
+	size_t AllocationCount() const { return m_allocations.count(); }
+
+private:
+
+	template <typename T>
+	_TweenPool<T>& TweenPool();
+	template <typename T>
+	_SpringPool<T>& SpringPool();
+
+	bool PrepareInstance(AnimationId id, AnimationEvents& events, AnimationInstance& instance);
+	size_t AttachBatch(AnimationId id, void* const* objs, size_t count, const float* durations, size_t stride, size_t repeat, AnimationEvents& events, InstanceId* ids);
+	void InsertInstance(InstanceId id, const AnimationInstance& instance, const AnimationEvents* overrides);
+	void ReleaseInstance(size_t index);
+	void EraseAnimation(Animation* animation);
+	static void EvaluateTimeline(const Animation& animation, float& cursor, float to, bool reversed, void* obj);
+	static float SampleKeyframes(const Animation& animation, uint32_t& segment, float t);
+	void SleepInstance(uint32_t index, float seconds);
+	void WakeInstances();
+	void ThawGroups(float dt);
+
+	bool Frozen(uint32_t index) const { return (m_frozen >> m_instances.group[index]) & 1u; }
+	bool Waiting(uint32_t index) const;
+	void ApplyGroupScale(uint32_t group, float scale);
+	void ApplyFreeze(uint32_t groups, float seconds);
+	void ApplyUnfreeze(uint32_t groups);
+
+	_WorkerScratch* DeferredScratch();
+	void Submit(_AnimationCommand::Type type, InstanceId id, uint32_t arg = 0);
+	void SubmitTagged(_AnimationCommand::Type type, uint32_t tags);
+	void SubmitMany(_AnimationCommand::Type type, const InstanceId* ids, size_t count);
+	void SubmitWorld(_AnimationCommand::Type type, uint32_t arg, float value);
+	void Apply(const _AnimationCommand& command);
+	void ApplyAt(_AnimationCommand::Type type, uint32_t index, uint32_t arg);
+	template <typename Selected>
+	void ApplySelected(_AnimationCommand::Type type, Selected selected);
+	void FlushCommands();
+
+	void UpdateRange(size_t begin, size_t end, _WorkerScratch& scratch);
+	void EndCycles(_WorkerScratch& scratch);
+
+	static void RunUpdateChunk(void* world, size_t task, size_t worker);
+	static void RunEndCycles(void* world, size_t task, size_t worker);
+
+	_CountingResource m_allocations;
+	std::pmr::memory_resource* m_resource = nullptr;
+
+	_AnimationRegistry m_animations;
+
+	_InstancePool m_instances;
+
+	std::pmr::vector<_Owned<_AnimationPoolBase>> m_typed_pools;
+	std::pmr::vector<_Owned<_AnimationPoolBase>> m_tween_pools;
+	std::pmr::vector<_Owned<_AnimationPoolBase>> m_spring_pools;
+
+	std::pmr::vector<Animation*> m_batched_animations;
+
+	static constexpr double TICKS_PER_SECOND = 1000.0;
+
+	double m_clock = 0.0;
+	_TimingWheel m_wheel;
+	std::pmr::vector<_WheelEntry> m_due;
+
+	_Owned<_WorkerPool> m_workers = nullptr;
+	std::pmr::vector<_WorkerScratch> m_scratch;
+	std::mutex m_command_mutex;
+	size_t m_chunk_size = 4096;
+	bool m_deferring = false;
+
+	float m_frame_dt = 0.0f;
+	size_t m_frame_count = 0;
+
+	float m_time_scale = 1.0f;
+	float m_group_scale[ANIM_GROUP_COUNT];
+	float m_thaw[ANIM_GROUP_COUNT];
+	uint32_t m_frozen = 0;
+
+	static thread_local AnimationWorld* s_current_world;
+	static thread_local size_t s_current_worker;
+
+};
+
+template <typename T, typename UpdateFn>
+TypedAnimation<T, UpdateFn> AnimationWorld::CreateTypedAnimation(UpdateFn update, AnimationEasing easing) {
+	auto pool = _MakeOwned<_TypedPool<T, UpdateFn>>(m_resource, m_resource, std::move(update), easing);
+	auto* raw = pool.get();
+	m_typed_pools.push_back(std::move(pool));
+	return TypedAnimation<T, UpdateFn>(raw);
+}
+
+template <typename T>
+_TweenPool<T>& AnimationWorld::TweenPool() {
+	size_t index = _TypeIndex<T>();
+	if (index >= m_tween_pools.size()) m_tween_pools.resize(index + 1);
+	if (!m_tween_pools[index]) m_tween_pools[index] = _MakeOwned<_TweenPool<T>>(m_resource, m_resource);
+	return static_cast<_TweenPool<T>&>(*m_tween_pools[index]);
+}
+
+template <typename T>
+TweenId<T> AnimationWorld::Tween(T* target, T start, T end, float duration, AnimationEasing easing, size_t repeat) {
+	std::unique_lock<std::mutex> lock(m_command_mutex, std::defer_lock);
+	if (m_deferring) lock.lock();
+	return { TweenPool<T>().insert(target, start, end, duration, easing, repeat) };
+}
+
+template <typename T>
+void AnimationWorld::Retarget(TweenId<T> id, T end) {
+	std::unique_lock<std::mutex> lock(m_command_mutex, std::defer_lock);
+	if (m_deferring) lock.lock();
+	TweenPool<T>().retarget(id.id, end);
+}
+
+template <typename T>
+bool AnimationWorld::HasTween(TweenId<T> id) {
+	std::unique_lock<std::mutex> lock(m_command_mutex, std::defer_lock);
+	if (m_deferring) lock.lock();
+	return TweenPool<T>().is_valid(id.id);
+}
+
+template <typename T>
+void AnimationWorld::Pause(TweenId<T> id) {
+	std::unique_lock<std::mutex> lock(m_command_mutex, std::defer_lock);
+	if (m_deferring) lock.lock();
+	TweenPool<T>().pause(id.id);
+}
+
+template <typename T>
+void AnimationWorld::Stop(TweenId<T> id) {
+	std::unique_lock<std::mutex> lock(m_command_mutex, std::defer_lock);
+	if (m_deferring) lock.lock();
+	TweenPool<T>().stop(id.id);
+}
+
+template <typename T>
+void AnimationWorld::Continue(TweenId<T> id) {
+	std::unique_lock<std::mutex> lock(m_command_mutex, std::defer_lock);
+	if (m_deferring) lock.lock();
+	TweenPool<T>().resume(id.id);
+}
+
+template <typename T>
+void AnimationWorld::Restart(TweenId<T> id) {
+	std::unique_lock<std::mutex> lock(m_command_mutex, std::defer_lock);
+	if (m_deferring) lock.lock();
+	TweenPool<T>().restart(id.id);
+}
+
+template <typename T>
+_SpringPool<T>& AnimationWorld::SpringPool() {
+	size_t index = _TypeIndex<T>();
+	if (index >= m_spring_pools.size()) m_spring_pools.resize(index + 1);
+	if (!m_spring_pools[index]) m_spring_pools[index] = _MakeOwned<_SpringPool<T>>(m_resource, m_resource);
+	return static_cast<_SpringPool<T>&>(*m_spring_pools[index]);
+}
+
+template <typename T>
+SpringId<T> AnimationWorld::Spring(T* target, T goal, SpringParams params, AnimationOnEnd onEnd) {
+	std::unique_lock<std::mutex> lock(m_command_mutex, std::defer_lock);
+	if (m_deferring) lock.lock();
+	return { SpringPool<T>().insert(target, goal, params, std::move(onEnd)) };
+}
+
+template <typename T>
+SpringId<T> AnimationWorld::SmoothDamp(T* target, T goal, float smooth_time, AnimationOnEnd onEnd) {
+	SpringParams params;
+	float omega = 2.0f / (smooth_time > 0.0f ? smooth_time : 1e-3f);
+	params.stiffness = omega * omega;
+	params.damping = 2.0f * omega;
+	return Spring(target, goal, params, std::move(onEnd));
+}
+
+template <typename T>
+bool AnimationWorld::HasSpring(SpringId<T> id) {
+	std::unique_lock<std::mutex> lock(m_command_mutex, std::defer_lock);
+	if (m_deferring) lock.lock();
+	return SpringPool<T>().is_valid(id.id);
+}
+
+template <typename T>
+void AnimationWorld::SetSpringTarget(SpringId<T> id, T goal) {
+	std::unique_lock<std::mutex> lock(m_command_mutex, std::defer_lock);
+	if (m_deferring) lock.lock();
+	SpringPool<T>().retarget(id.id, goal);
+}
+
+template <typename T>
+void AnimationWorld::Stop(SpringId<T> id) {
+	std::unique_lock<std::mutex> lock(m_command_mutex, std::defer_lock);
+	if (m_deferring) lock.lock();
+	SpringPool<T>().erase(id.id);
+}
+
+// Static facade over the default AnimationWorld.
+class AnimationHandler {
+
+public:
+	static const AnimationId CreateAnimation(AnimationEvents events, AnimationEasing easing = EASE_LINEAR);
+	static const AnimationId CreateAnimation(AnimationEvents events, CubicBezier curve);
+	static const AnimationId CreateTimeline(const Timeline& timeline, AnimationEvents events = { }, AnimationEasing easing = EASE_LINEAR);
+	static const AnimationId CreateKeyframes(const Keyframe* keys, size_t count, AnimationEvents events, AnimationEasing easing = EASE_LINEAR);
+	static const AnimationId CreateKeyframes(std::initializer_list<Keyframe> keys, AnimationEvents events, AnimationEasing easing = EASE_LINEAR) {
+		return CreateKeyframes(keys.begin(), keys.size(), events, easing);
+	}
+	static InstanceId AttachAnimation(AnimationId id, void* obj, float duration, size_t repeat, AnimationEvents events, float delay = 0.0f, float repeat_delay = 0.0f);
+	static size_t AttachAnimationBatch(AnimationId id, void* const* objs, size_t count, float duration, size_t repeat, AnimationEvents events, InstanceId* ids = nullptr);
+	static size_t AttachAnimationBatch(AnimationId id, void* const* objs, size_t count, const float* durations, size_t repeat, AnimationEvents events, InstanceId* ids = nullptr);
+	static void UpdateAnimations(float dt);
+
+	template <typename T, typename UpdateFn>
+	static TypedAnimation<T, UpdateFn> CreateTypedAnimation(UpdateFn update, AnimationEasing easing = EASE_LINEAR) {
+		return s_world.CreateTypedAnimation<T>(std::move(update), easing);
+	}
+
+	template <typename T>
+	static TweenId<T> Tween(T* target, T start, T end, float duration, AnimationEasing easing = EASE_LINEAR, size_t repeat = 1) {
+		return s_world.Tween(target, start, end, duration, easing, repeat);
+	}
+
+	template <typename T> static bool HasTween(TweenId<T> id) { return s_world.HasTween(id); }
+	template <typename T> static void Pause(TweenId<T> id) { s_world.Pause(id); }
+	template <typename T> static void Stop(TweenId<T> id) { s_world.Stop(id); }
+	template <typename T> static void Continue(TweenId<T> id) { s_world.Continue(id); }
+	template <typename T> static void Restart(TweenId<T> id) { s_world.Restart(id); }
+	template <typename T> static void Retarget(TweenId<T> id, T end) { s_world.Retarget(id, end); }
+
+	template <typename T>
+	static SpringId<T> Spring(T* target, T goal, SpringParams params = { }, AnimationOnEnd onEnd = nullptr) {
+		return s_world.Spring(target, goal, params, std::move(onEnd));
+	}
+
+	template <typename T>
+	static SpringId<T> SmoothDamp(T* target, T goal, float smooth_time, AnimationOnEnd onEnd = nullptr) {
+		return s_world.SmoothDamp(target, goal, smooth_time, std::move(onEnd));
+	}
+
+	template <typename T> static bool HasSpring(SpringId<T> id) { return s_world.HasSpring(id); }
+	template <typename T> static void SetSpringTarget(SpringId<T> id, T goal) { s_world.SetSpringTarget(id, goal); }
+	template <typename T> static void Stop(SpringId<T> id) { s_world.Stop(id); }
+
+	static bool HasAnimation(AnimationId id);
+	static void RemoveAnimation(AnimationId id);
+	static void ClearAnimations();
+
+	static void Pause(InstanceId i_id);
+	static void Stop(InstanceId id);
+	static void Continue(InstanceId id);
+	static void Restart(InstanceId id);
+	static void SetEasing(InstanceId id, AnimationEasing easing);
+	static void SetDirection(InstanceId id, AnimationDirection direction);
+
+	static void Pause(const InstanceId* ids, size_t count);
+	static void Stop(const InstanceId* ids, size_t count);
+	static void Continue(const InstanceId* ids, size_t count);
+	static void Restart(const InstanceId* ids, size_t count);
+
+	static void SetTags(InstanceId id, uint32_t tags);
+	static void PauseAll(uint32_t tags);
+	static void StopAll(uint32_t tags);
+	static void ContinueAll(uint32_t tags);
+	static void RestartAll(uint32_t tags);
+
+	static void SetTimeScale(float scale);
+	static void SetSpeed(InstanceId id, float speed);
+	static void SetGroup(InstanceId id, uint32_t group);
+	static void SetGroupScale(uint32_t group, float scale);
+	static void Freeze(uint32_t groups);
+	static void Unfreeze(uint32_t groups);
+	static void Hitstop(uint32_t groups, float seconds);
+
+	static void Reserve(size_t instances, bool hard_capacity = false);
+	template <typename T> static void ReserveTweens(size_t count) { s_world.ReserveTweens<T>(count); }
+	template <typename T> static void ReserveSprings(size_t count) { s_world.ReserveSprings<T>(count); }
+	static size_t AllocationCount();
+
+	static AnimationWorld& DefaultWorld();
+
+	// Rebuilds the default world on `resource`, dropping everything it held.
+	static void SetMemoryResource(std::pmr::memory_resource* resource);
+
+private:
+
+	static AnimationWorld s_world;
+
+};
+
+#ifdef ANIM_NAMESPACE
+}
+#endif
+
+#ifdef ANIMATE_HPP_IMPLEMENTATION
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <cmath>
+
+#ifdef ANIM_NAMESPACE
+namespace Anim {
+#endif
+
+// Lane types for the easing kernels. Every polynomial easing is written once as
+// a template over V and instantiated for float and for the widest vector the
+// target supports, so the scalar tail and the SIMD body share one formula.
+
+inline bool _Less(float a, float b) { return a < b; }
+inline float _Select(bool mask, float a, float b) { return mask ? a : b; }
+
+#if defined(__AVX2__)
+
+struct _Lanes {
+	__m256 v;
+	_Lanes(__m256 value) : v(value) { }
+	_Lanes(float value) : v(_mm256_set1_ps(value)) { }
+	static constexpr size_t width = 8;
+	static _Lanes load(const float* p) { return _mm256_loadu_ps(p); }
+	void store(float* p) const { _mm256_storeu_ps(p, v); }
+};
+
+inline _Lanes operator+(_Lanes a, _Lanes b) { return _mm256_add_ps(a.v, b.v); }
+inline _Lanes operator-(_Lanes a, _Lanes b) { return _mm256_sub_ps(a.v, b.v); }
+inline _Lanes operator*(_Lanes a, _Lanes b) { return _mm256_mul_ps(a.v, b.v); }
+inline _Lanes _Less(_Lanes a, _Lanes b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+inline _Lanes _Select(_Lanes mask, _Lanes a, _Lanes b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+
+#define ANIM_EASE_SIMD
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+struct _Lanes {
+	__m128 v;
+	_Lanes(__m128 value) : v(value) { }
+	_Lanes(float value) : v(_mm_set1_ps(value)) { }
+	static constexpr size_t width = 4;
+	static _Lanes load(const float* p) { return _mm_loadu_ps(p); }
+	void store(float* p) const { _mm_storeu_ps(p, v); }
+};
+
+inline _Lanes operator+(_Lanes a, _Lanes b) { return _mm_add_ps(a.v, b.v); }
+inline _Lanes operator-(_Lanes a, _Lanes b) { return _mm_sub_ps(a.v, b.v); }
+inline _Lanes operator*(_Lanes a, _Lanes b) { return _mm_mul_ps(a.v, b.v); }
+inline _Lanes _Less(_Lanes a, _Lanes b) { return _mm_cmplt_ps(a.v, b.v); }
+inline _Lanes _Select(_Lanes mask, _Lanes a, _Lanes b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+
+#define ANIM_EASE_SIMD
+
+#elif defined(__ARM_NEON)
+
+struct _Lanes {
+	float32x4_t v;
+	_Lanes(float32x4_t value) : v(value) { }
+	_Lanes(float value) : v(vdupq_n_f32(value)) { }
+	static constexpr size_t width = 4;
+	static _Lanes load(const float* p) { return vld1q_f32(p); }
+	void store(float* p) const { vst1q_f32(p, v); }
+};
+
+inline _Lanes operator+(_Lanes a, _Lanes b) { return vaddq_f32(a.v, b.v); }
+inline _Lanes operator-(_Lanes a, _Lanes b) { return vsubq_f32(a.v, b.v); }
+inline _Lanes operator*(_Lanes a, _Lanes b) { return vmulq_f32(a.v, b.v); }
+inline uint32x4_t _Less(_Lanes a, _Lanes b) { return vcltq_f32(a.v, b.v); }
+inline _Lanes _Select(uint32x4_t mask, _Lanes a, _Lanes b) { return vbslq_f32(mask, a.v, b.v); }
+
+#define ANIM_EASE_SIMD
+
+#endif
+
+template <typename V>
+inline V _EaseOutBounce(V t) {
+	const float n1 = 7.5625f;
+	const float d1 = 2.75f;
+
+	V a = t;
+	V b = t - V(1.5f / d1);
+	V c = t - V(2.25f / d1);
+	V d = t - V(2.625f / d1);
+
+	V result = V(n1) * d * d + V(0.984375f);
+	result = _Select(_Less(t, V(2.5f / d1)), V(n1) * c * c + V(0.9375f), result);
+	result = _Select(_Less(t, V(2.0f / d1)), V(n1) * b * b + V(0.75f), result);
+	result = _Select(_Less(t, V(1.0f / d1)), V(n1) * a * a, result);
+	return result;
+}
+
+template <AnimationEasing E, typename V>
+inline V _EaseKernel(V t) {
+
+	const float c1 = 1.70158f;
+	const float c2 = c1 * 1.525f;
+	const float c3 = c1 + 1.0f;
+
+	V one = V(1.0f);
+	V half = V(0.5f);
+	V u = one - t;
+	V w = V(2.0f) - V(2.0f) * t;
+
+	if constexpr (E == EASE_IN_QUAD) return t * t;
+	else if constexpr (E == EASE_OUT_QUAD) return one - u * u;
+	else if constexpr (E == EASE_IN_OUT_QUAD) return _Select(_Less(t, half), V(2.0f) * t * t, one - w * w * half);
+	else if constexpr (E == EASE_IN_CUBIC) return t * t * t;
+	else if constexpr (E == EASE_OUT_CUBIC) return one - u * u * u;
+	else if constexpr (E == EASE_IN_OUT_CUBIC) return _Select(_Less(t, half), V(4.0f) * t * t * t, one - w * w * w * half);
+	else if constexpr (E == EASE_IN_QUART) return t * t * t * t;
+	else if constexpr (E == EASE_OUT_QUART) return one - u * u * u * u;
+	else if constexpr (E == EASE_IN_OUT_QUART) return _Select(_Less(t, half), V(8.0f) * t * t * t * t, one - w * w * w * w * half);
+	else if constexpr (E == EASE_IN_BACK) return V(c3) * t * t * t - V(c1) * t * t;
+	else if constexpr (E == EASE_OUT_BACK) {
+		V s = t - one;
+		return one + V(c3) * s * s * s + V(c1) * s * s;
+	}
+	else if constexpr (E == EASE_IN_OUT_BACK) {
+		V a = V(2.0f) * t;
+		V b = a - V(2.0f);
+		V in = a * a * (V(c2 + 1.0f) * a - V(c2)) * half;
+		V out = (b * b * (V(c2 + 1.0f) * b + V(c2)) + V(2.0f)) * half;
+		return _Select(_Less(t, half), in, out);
+	}
+	else if constexpr (E == EASE_OUT_BOUNCE) return _EaseOutBounce(t);
+	else if constexpr (E == EASE_IN_BOUNCE) return one - _EaseOutBounce(u);
+	else if constexpr (E == EASE_IN_OUT_BOUNCE) {
+		V in = (one - _EaseOutBounce(one - V(2.0f) * t)) * half;
+		V out = (one + _EaseOutBounce(V(2.0f) * t - one)) * half;
+		return _Select(_Less(t, half), in, out);
+	}
+	else return t;
+}
+
+template <AnimationEasing E>
+void _EaseBatchKernel(const float* in, float* out, size_t count) {
+	size_t i = 0;
+#ifdef ANIM_EASE_SIMD
+	for (; i + _Lanes::width <= count; i += _Lanes::width) {
+		_EaseKernel<E>(_Lanes::load(in + i)).store(out + i);
+	}
+#endif
+	for (; i < count; ++i) out[i] = _EaseKernel<E>(in[i]);
+}
+
+#define ANIM_SIMD_EASINGS(X) \
+	X(EASE_IN_QUAD) X(EASE_OUT_QUAD) X(EASE_IN_OUT_QUAD) \
+	X(EASE_IN_CUBIC) X(EASE_OUT_CUBIC) X(EASE_IN_OUT_CUBIC) \
+	X(EASE_IN_QUART) X(EASE_OUT_QUART) X(EASE_IN_OUT_QUART) \
+	X(EASE_IN_BACK) X(EASE_OUT_BACK) X(EASE_IN_OUT_BACK) \
+	X(EASE_IN_BOUNCE) X(EASE_OUT_BOUNCE) X(EASE_IN_OUT_BOUNCE)
+
+float Ease(AnimationEasing easing, float t) {
+
+	const float pi = 3.14159265358979f;
+	const float c4 = 2.0f * pi / 3.0f;
+	const float c5 = 2.0f * pi / 4.5f;
+
+	switch (easing) {
+
+#define ANIM_EASE_CASE(E) case E: return _EaseKernel<E>(t);
+		ANIM_SIMD_EASINGS(ANIM_EASE_CASE)
+#undef ANIM_EASE_CASE
+
+		case EASE_IN_EXPO: return t <= 0.0f ? 0.0f : std::exp2(10.0f * t - 10.0f);
+		case EASE_OUT_EXPO: return t >= 1.0f ? 1.0f : 1.0f - std::exp2(-10.0f * t);
+		case EASE_IN_OUT_EXPO:
+			if (t <= 0.0f) return 0.0f;
+			if (t >= 1.0f) return 1.0f;
+			return t < 0.5f ? std::exp2(20.0f * t - 10.0f) * 0.5f : (2.0f - std::exp2(-20.0f * t + 10.0f)) * 0.5f;
+
+		case EASE_IN_SINE: return 1.0f - std::cos(t * pi * 0.5f);
+		case EASE_OUT_SINE: return std::sin(t * pi * 0.5f);
+		case EASE_IN_OUT_SINE: return -(std::cos(pi * t) - 1.0f) * 0.5f;
+
+		case EASE_IN_ELASTIC:
+			if (t <= 0.0f) return 0.0f;
+			if (t >= 1.0f) return 1.0f;
+			return -std::exp2(10.0f * t - 10.0f) * std::sin((t * 10.0f - 10.75f) * c4);
+		case EASE_OUT_ELASTIC:
+			if (t <= 0.0f) return 0.0f;
+			if (t >= 1.0f) return 1.0f;
+			return std::exp2(-10.0f * t) * std::sin((t * 10.0f - 0.75f) * c4) + 1.0f;
+		case EASE_IN_OUT_ELASTIC:
+			if (t <= 0.0f) return 0.0f;
+			if (t >= 1.0f) return 1.0f;
+			return t < 0.5f
+				? -(std::exp2(20.0f * t - 10.0f) * std::sin((20.0f * t - 11.125f) * c5)) * 0.5f
+				: (std::exp2(-20.0f * t + 10.0f) * std::sin((20.0f * t - 11.125f) * c5)) * 0.5f + 1.0f;
+
+		default: return t;
+	}
+}
+
+void EaseBatch(AnimationEasing easing, const float* in, float* out, size_t count) {
+	switch (easing) {
+
+#define ANIM_EASE_CASE(E) case E: _EaseBatchKernel<E>(in, out, count); return;
+		ANIM_SIMD_EASINGS(ANIM_EASE_CASE)
+#undef ANIM_EASE_CASE
+
+		case EASE_LINEAR:
+		case EASE_CUBIC_BEZIER:
+			if (in != out) std::memcpy(out, in, count * sizeof(float));
+			return;
+
+		default:
+			for (size_t i = 0; i < count; ++i) out[i] = Ease(easing, in[i]);
+			return;
+	}
+}
+
+_InstancePool::_InstancePool(std::pmr::memory_resource* resource)
+	: time(resource), duration(resource), state(resource), easing(resource), repeat(resource), repeat_count(resource), obj(resource),
+	animation(resource), overrides(resource), repeat_delay(resource), wake(resource), resume(resource),
+	tags(resource), rate(resource), speed(resource), group(resource),
+	direction(resource), reversed(resource), cursor(resource), segment(resource), m_index(resource), m_override_events(resource), m_free_overrides(resource) { }
+
+void _InstancePool::insert(InstanceId reserved, const AnimationInstance& instance, const AnimationEvents* events) {
+
+	m_index.bind(reserved);
+
+	repeat_delay.push_back(instance.repeat_delay);
+	wake.push_back(0);
+	resume.push_back(instance.state);
+	tags.push_back(0);
+	rate.push_back(1.0f);
+	speed.push_back(1.0f);
+	group.push_back(0);
+	direction.push_back(instance.direction);
+	reversed.push_back(instance.direction == ANIM_REVERSE);
+	cursor.push_back(NAN);
+	segment.push_back(UINT32_MAX);
+
+	time.push_back(instance.time);
+	duration.push_back(instance.duration);
+	state.push_back(instance.state);
+	easing.push_back(instance.easing);
+	repeat.push_back(instance.repeat);
+	repeat_count.push_back(instance.repeat_count);
+	obj.push_back(instance.obj);
+	animation.push_back(instance.animation);
+
+	uint32_t override_index = UINT32_MAX;
+
+	if (events) {
+		if (!m_free_overrides.empty()) {
+			override_index = m_free_overrides.back();
+			m_free_overrides.pop_back();
+			m_override_events[override_index] = *events;
+		} else {
+			override_index = (uint32_t)m_override_events.size();
+			m_override_events.push_back(*events);
+		}
+	}
+
+	overrides.push_back(override_index);
+}
+
+void _InstancePool::insert_batch(const AnimationInstance& instance, void* const* objs, const float* durations, size_t stride,
+	size_t count, const AnimationEvents* events, InstanceId* ids) {
+
+	size_t first = size();
+	size_t total = first + count;
+
+	// Grown geometrically, so many small batches do not reallocate every time.
+	if (total > m_index.reserved()) m_index.reserve(std::max(total, 2 * m_index.reserved()));
+	for_each_column([total](auto& column) { column.resize(total); });
+
+	std::fill(time.begin() + first, time.end(), instance.time);
+	std::fill(state.begin() + first, state.end(), instance.state);
+	std::fill(easing.begin() + first, easing.end(), instance.easing);
+	std::fill(repeat.begin() + first, repeat.end(), instance.repeat);
+	std::fill(repeat_count.begin() + first, repeat_count.end(), instance.repeat_count);
+	std::fill(animation.begin() + first, animation.end(), instance.animation);
+	std::fill(repeat_delay.begin() + first, repeat_delay.end(), instance.repeat_delay);
+	std::fill(wake.begin() + first, wake.end(), 0);
+	std::fill(resume.begin() + first, resume.end(), instance.state);
+	std::fill(overrides.begin() + first, overrides.end(), UINT32_MAX);
+	std::fill(rate.begin() + first, rate.end(), 1.0f);
+	std::fill(speed.begin() + first, speed.end(), 1.0f);
+	std::fill(direction.begin() + first, direction.end(), instance.direction);
+	std::fill(reversed.begin() + first, reversed.end(), instance.direction == ANIM_REVERSE);
+	std::fill(cursor.begin() + first, cursor.end(), NAN);
+	std::fill(segment.begin() + first, segment.end(), UINT32_MAX);
+
+	for (size_t k = 0; k < count; ++k) {
+		duration[first + k] = durations[k * stride];
+		obj[first + k] = objs[k];
+	}
+
+	for (size_t k = 0; k < count; ++k) {
+		InstanceId id = m_index.acquire();
+		m_index.bind(id);
+		if (ids) ids[k] = id;
+	}
+
+	if (!events) return;
+
+	for (size_t k = 0; k < count; ++k) {
+		uint32_t override_index;
+
+		if (!m_free_overrides.empty()) {
+			override_index = m_free_overrides.back();
+			m_free_overrides.pop_back();
+			m_override_events[override_index] = *events;
+		} else {
+			override_index = (uint32_t)m_override_events.size();
+			m_override_events.push_back(*events);
+		}
+
+		overrides[first + k] = override_index;
+	}
+}
+
+void _InstancePool::erase(InstanceId id) {
+	if (!m_index.is_valid(id)) return;
+
+	park(m_index.index_of(id));
+
+	uint32_t index = m_index.erase(id);
+
+	if (overrides[index] != UINT32_MAX) {
+		m_override_events[overrides[index]] = { };
+		m_free_overrides.push_back(overrides[index]);
+	}
+
+	for_each_column([index](auto& column) { _SwapRemove(column, index); });
+}
+
+void _InstancePool::swap_columns(uint32_t a, uint32_t b) {
+	if (a == b) return;
+	for_each_column([a, b](auto& column) { std::swap(column[a], column[b]); });
+}
+
+void _InstancePool::reserve(size_t capacity, bool hard) {
+	m_index.reserve(capacity);
+	m_index.limit(hard ? capacity : SIZE_MAX);
+	m_free_overrides.reserve(capacity);
+	for_each_column([capacity](auto& column) { column.reserve(capacity); });
+}
+
+uint32_t _InstancePool::park(uint32_t index) {
+	uint32_t moved = m_index.park(index);
+	swap_columns(index, moved);
+	return moved;
+}
+
+uint32_t _InstancePool::unpark(uint32_t index) {
+	uint32_t moved = m_index.unpark(index);
+	swap_columns(index, moved);
+	return moved;
+}
+
+void _TimingWheel::schedule(InstanceId id, uint64_t tick) {
+
+	uint32_t node = m_free;
+
+	if (node != NONE) {
+		m_free = m_nodes[node].next;
+	} else {
+		node = (uint32_t)m_nodes.size();
+		m_nodes.push_back({ });
+	}
+
+	m_nodes[node].entry = { id, tick };
+
+	if (tick > m_now) {
+		link(node);
+	} else {
+		uint32_t& next = head(0, m_now + 1);
+		m_nodes[node].next = next;
+		next = node;
+	}
+}
+
+void _TimingWheel::link(uint32_t node) {
+
+	uint64_t tick = m_nodes[node].entry.tick;
+	uint64_t delta = tick - m_now;
+
+	for (int level = 0; level < LEVELS; ++level) {
+		uint64_t span = SLOTS << (BITS * level);
+		if (delta < span || level == LEVELS - 1) {
+			if (delta >= span) tick = m_now + span - 1;
+			uint32_t& first = head(level, tick);
+			m_nodes[node].next = first;
+			first = node;
+			return;
+		}
+	}
+}
+
+void _TimingWheel::drain(uint32_t node, std::pmr::vector<_WheelEntry>& due) {
+	while (node != NONE) {
+		uint32_t next = m_nodes[node].next;
+
+		if (m_nodes[node].entry.tick <= m_now) {
+			due.push_back(m_nodes[node].entry);
+			m_nodes[node].next = m_free;
+			m_free = node;
+		} else {
+			link(node);
+		}
+
+		node = next;
+	}
+}
+
+void _TimingWheel::advance(uint64_t now, std::pmr::vector<_WheelEntry>& due) {
+
+	while (m_now < now) {
+
+		m_now++;
+
+		for (int level = 1; level < LEVELS; ++level) {
+			if ((m_now & ((uint64_t(1) << (BITS * level)) - 1)) != 0) break;
+
+			uint32_t& first = head(level, m_now);
+			uint32_t node = first;
+			first = NONE;
+			drain(node, due);
+		}
+
+		uint32_t& first = head(0, m_now);
+		uint32_t node = first;
+		first = NONE;
+		drain(node, due);
+	}
+}
+
+const AnimationEvents& _InstancePool::events(size_t index) const {
+	if (overrides[index] != UINT32_MAX) return m_override_events[overrides[index]];
+	return animation[index]->events;
+}
+
+bool _InstancePool::batched(size_t index) const {
+	const AnimationEvents& de = animation[index]->events;
+	if (!de.onUpdateBatch) return false;
+	return overrides[index] == UINT32_MAX || !m_override_events[overrides[index]].onUpdate;
+}
+
+Animation::Animation(AnimationId id, AnimationEvents events, AnimationEasing easing, std::pmr::memory_resource* resource)
+	: batch_progress(resource), batch_objs(resource), timeline(resource), timeline_reach(resource),
+	key_times(resource), key_values(resource), key_easing(resource), bezier(resource) {
+	this->id = id;
+	this->events = events;
+	this->easing = easing;
+}
+
+AnimationWorld::AnimationWorld(std::pmr::memory_resource* resource)
+	: m_allocations(resource), m_resource(ANIM_COUNT_ALLOCATIONS ? &m_allocations : resource),
+	m_animations(m_resource), m_instances(m_resource), m_typed_pools(m_resource), m_tween_pools(m_resource), m_spring_pools(m_resource),
+	m_batched_animations(m_resource), m_wheel(m_resource), m_due(m_resource), m_scratch(m_resource) {
+	m_scratch.emplace_back(m_resource);
+	std::fill(std::begin(m_group_scale), std::end(m_group_scale), 1.0f);
+	std::fill(std::begin(m_thaw), std::end(m_thaw), 0.0f);
+}
+
+AnimationId _AnimationRegistry::insert(const AnimationEvents& events, AnimationEasing easing) {
+
+	AnimationId id = { m_index.insert() };
+
+	if (id.handle.slot_index == m_animations.size()) {
+		m_animations.emplace_back(id, events, easing, m_animations.get_allocator().resource());
+		return id;
+	}
+
+	Animation& animation = m_animations[id.handle.slot_index];
+	animation.id = id;
+	animation.events = events;
+	animation.easing = easing;
+	animation.instance_count = 0;
+	animation.removed = false;
+	return id;
+}
+
+void _AnimationRegistry::erase(AnimationId id) {
+	if (!m_index.is_valid(id.handle)) return;
+	Animation& animation = m_animations[id.handle.slot_index];
+	animation.events = { };
+	animation.timeline.clear();
+	animation.timeline_reach.clear();
+	animation.key_times.clear();
+	animation.key_values.clear();
+	animation.key_easing.clear();
+	animation.bezier.clear();
+	m_index.erase(id.handle);
+}
+
+const AnimationId AnimationWorld::CreateAnimation(AnimationEvents events, AnimationEasing easing) {
+	return m_animations.insert(events, easing);
+}
+
+const AnimationId AnimationWorld::CreateAnimation(AnimationEvents events, CubicBezier curve) {
+
+	if (!(curve.x1 >= 0.0f && curve.x1 <= 1.0f && curve.x2 >= 0.0f && curve.x2 <= 1.0f)) {
+		throw std::invalid_argument("CreateAnimation: cubic-bezier x1 and x2 must be in [0, 1]");
+	}
+
+	AnimationId id = m_animations.insert(events, EASE_CUBIC_BEZIER);
+	Animation* animation = m_animations.get(id);
+
+	// Polynomial coefficients of x(s) and y(s) with P0 = (0, 0) and P3 = (1, 1).
+	double cx = 3.0 * curve.x1, bx = 3.0 * (curve.x2 - curve.x1) - cx, ax = 1.0 - cx - bx;
+	double cy = 3.0 * curve.y1, by = 3.0 * (curve.y2 - curve.y1) - cy, ay = 1.0 - cy - by;
+
+	auto curve_x = [&](double s) { return ((ax * s + bx) * s + cx) * s; };
+	auto slope_x = [&](double s) { return (3.0 * ax * s + 2.0 * bx) * s + cx; };
+
+	animation->bezier.resize(Animation::BEZIER_SAMPLES + 1);
+
+	// x(s) is monotonic, so each sample starts from the previous solution and
+	// refines it with Newton steps, falling back to bisection on flat spots.
+	double s = 0.0;
+
+	for (size_t k = 0; k <= Animation::BEZIER_SAMPLES; ++k) {
+		double x = (double)k / Animation::BEZIER_SAMPLES;
+		double low = 0.0, high = 1.0;
+
+		for (int iteration = 0; iteration < 16; ++iteration) {
+			double error = curve_x(s) - x;
+			if (std::abs(error) < 1e-7) break;
+
+			if (error > 0.0) high = s;
+			else low = s;
+
+			double slope = slope_x(s);
+			double next = std::abs(slope) > 1e-6 ? s - error / slope : low - 1.0;
+			s = next > low && next < high ? next : (low + high) * 0.5;
+		}
+
+		animation->bezier[k] = (float)(((ay * s + by) * s + cy) * s);
+	}
+
+	return id;
+}
+
+float Animation::ease(AnimationEasing easing, float t) const {
+	if (easing != EASE_CUBIC_BEZIER || bezier.empty()) return Ease(easing, t);
+
+	if (t <= 0.0f) return bezier.front();
+	if (t >= 1.0f) return bezier.back();
+
+	float x = t * BEZIER_SAMPLES;
+	size_t k = (size_t)x;
+	return bezier[k] + (bezier[k + 1] - bezier[k]) * (x - (float)k);
+}
+
+Timeline& Timeline::Then(AnimationId id, float duration) {
+	m_last = m_end;
+	m_steps.push_back({ id, m_last, duration });
+	m_end = m_last + duration;
+	return *this;
+}
+
+Timeline& Timeline::Then(const Timeline& timeline) {
+	m_last = m_end;
+	Append(timeline, m_last);
+	return *this;
+}
+
+Timeline& Timeline::With(AnimationId id, float duration, float offset) {
+	m_steps.push_back({ id, m_last + offset, duration });
+	m_end = std::max(m_end, m_last + offset + duration);
+	return *this;
+}
+
+Timeline& Timeline::With(const Timeline& timeline, float offset) {
+	Append(timeline, m_last + offset);
+	return *this;
+}
+
+Timeline& Timeline::Wait(float seconds) {
+	m_end += seconds;
+	m_last = m_end;
+	return *this;
+}
+
+void Timeline::Append(const Timeline& timeline, float start) {
+	// Copied first: `timeline` may be *this.
+	std::vector<Step> steps = timeline.m_steps;
+	for (Step step : steps) {
+		step.start += start;
+		m_steps.push_back(step);
+	}
+	m_end = std::max(m_end, start + timeline.m_end);
+}
+
+const AnimationId AnimationWorld::CreateTimeline(const Timeline& timeline, AnimationEvents events, AnimationEasing easing) {
+
+	float total = timeline.Duration();
+	if (!(total > 0.0f)) throw std::invalid_argument("CreateTimeline: timeline has no duration");
+
+	for (const auto& step : timeline.m_steps) {
+		Animation* animation = m_animations.get(step.id);
+		if (!animation || animation->removed) throw std::out_of_range("CreateTimeline: invalid animation id");
+		if (!animation->timeline.empty()) throw std::invalid_argument("CreateTimeline: nest Timelines, not timeline templates");
+	}
+
+	AnimationId id = m_animations.insert(events, easing);
+	Animation* compiled = m_animations.get(id);
+
+	for (const auto& step : timeline.m_steps) {
+		Animation* animation = m_animations.get(step.id);
+		animation->instance_count++;
+		compiled->timeline.push_back({ step.start / total, (step.start + step.duration) / total, animation });
+	}
+
+	std::stable_sort(compiled->timeline.begin(), compiled->timeline.end(),
+		[](const _TimelineEntry& a, const _TimelineEntry& b) { return a.start < b.start; });
+
+	float reach = -INFINITY;
+	for (const auto& entry : compiled->timeline) {
+		reach = std::max(reach, entry.end);
+		compiled->timeline_reach.push_back(reach);
+	}
+
+	return id;
+}
+
+const AnimationId AnimationWorld::CreateKeyframes(const Keyframe* keys, size_t count, AnimationEvents events, AnimationEasing easing) {
+
+	if (count == 0) throw std::invalid_argument("CreateKeyframes: no keys");
+
+	for (size_t k = 1; k < count; ++k) {
+		if (keys[k].time < keys[k - 1].time) throw std::invalid_argument("CreateKeyframes: keys are not sorted by time");
+	}
+
+	AnimationId id = m_animations.insert(events, easing);
+	Animation* animation = m_animations.get(id);
+
+	for (size_t k = 0; k < count; ++k) {
+		animation->key_times.push_back(keys[k].time);
+		animation->key_values.push_back(keys[k].value);
+		animation->key_easing.push_back(keys[k].easing);
+	}
+
+	return id;
+}
+
+// `segment` is the segment found by the last sample, UINT32_MAX when unknown.
+// It is reused while `t` stays inside it, advanced by one when `t` moves on to
+// the next segment and searched for otherwise.
+float AnimationWorld::SampleKeyframes(const Animation& animation, uint32_t& segment, float t) {
+	const float* times = animation.key_times.data();
+	const float* values = animation.key_values.data();
+	uint32_t last = (uint32_t)animation.key_times.size() - 1;
+
+	if (t <= times[0]) return values[0];
+	if (t >= times[last]) return values[last];
+
+	uint32_t k = segment;
+
+	if (k < last && t >= times[k] && k + 1 < last && t >= times[k + 1]) ++k;
+
+	if (k >= last || t < times[k] || t >= times[k + 1]) {
+		k = (uint32_t)(std::upper_bound(times, times + last + 1, t) - times) - 1;
+	}
+
+	segment = k;
+
+	float length = times[k + 1] - times[k];
+	float local = length > 0.0f ? (t - times[k]) / length : 1.0f;
+	return values[k] + (values[k + 1] - values[k]) * Ease(animation.key_easing[k], local);
+}
+
+// Plays the steps of a timeline between the playhead of the last update (NaN at
+// the start of a cycle) and `to`, both in progress of the whole timeline.
+void AnimationWorld::EvaluateTimeline(const Animation& animation, float& cursor, float to, bool reversed, void* obj) {
+	const auto& entries = animation.timeline;
+	const auto& reach = animation.timeline_reach;
+
+	float from = cursor;
+	bool fresh = from != from;
+	bool forward = fresh ? !reversed : to >= from;
+	if (fresh) from = forward ? -INFINITY : INFINITY;
+	cursor = to;
+
+	float low = forward ? from : to;
+	float high = forward ? to : from;
+
+	// Forward covers (from, to], reverse [to, from).
+	size_t first = forward
+		? std::upper_bound(reach.begin(), reach.end(), low) - reach.begin()
+		: std::lower_bound(reach.begin(), reach.end(), low) - reach.begin();
+	size_t last = forward
+		? std::upper_bound(entries.begin(), entries.end(), high, [](float t, const _TimelineEntry& e) { return t < e.start; }) - entries.begin()
+		: std::upper_bound(entries.begin(), entries.end(), high, [](float t, const _TimelineEntry& e) { return t <= e.start; }) - entries.begin();
+
+	for (size_t k = first; k < last; ++k) {
+		const _TimelineEntry& entry = entries[k];
+
+		if (forward ? entry.end <= low : entry.end < low) continue;
+
+		const AnimationEvents& events = entry.animation->events;
+		float length = entry.end - entry.start;
+		float local = length > 0.0f ? std::clamp((to - entry.start) / length, 0.0f, 1.0f) : (to >= entry.start ? 1.0f : 0.0f);
+		float progress = entry.animation->ease(entry.animation->easing, local);
+
+		if (!entry.animation->key_times.empty()) {
+			uint32_t segment = UINT32_MAX;
+			progress = SampleKeyframes(*entry.animation, segment, progress);
+		}
+
+		if (forward && entry.start > from) {
+			if (events.onStart) events.onStart();
+			if (events.onEachRepeatStart) events.onEachRepeatStart(obj);
+		}
+
+		if (events.onUpdate) events.onUpdate(progress, obj);
+		else if (events.onUpdateBatch) events.onUpdateBatch(&progress, &obj, 1);
+
+		if (forward && entry.end <= to) {
+			if (events.onEachRepeatEnd) events.onEachRepeatEnd(obj);
+			if (events.onEnd) events.onEnd();
+		}
+	}
+}
+
+InstanceId AnimationWorld::AttachAnimation(AnimationId id, void* obj, float duration, size_t repeat, AnimationEvents events, float delay, float repeat_delay) {
+	
+	AnimationInstance instance;
+	
+	instance.obj = obj;
+	instance.duration = duration;
+	instance.repeat = repeat;
+
+	instance.delay = delay;
+	instance.repeat_delay = repeat_delay;
+
+	bool has_overrides = PrepareInstance(id, events, instance);
+
+	if (_WorkerScratch* scratch = DeferredScratch()) {
+
+		_AnimationCommand command;
+		command.type = _AnimationCommand::CMD_ATTACH;
+		command.instance = instance;
+
+		// The template is pinned as soon as the attach is queued, so removing it
+		// before the flush cannot free its slot for another template.
+		{
+			std::lock_guard<std::mutex> lock(m_command_mutex);
+			if (m_instances.full()) return ANIM_INVALID_INSTANCE;
+			command.id = m_instances.acquire();
+			instance.animation->instance_count++;
+		}
+
+		if (has_overrides) {
+			command.events = (uint32_t)scratch->events.size();
+			scratch->events.push_back(events);
+		}
+
+		scratch->commands.push_back(command);
+		return command.id;
+	}
+
+	if (m_instances.full()) return ANIM_INVALID_INSTANCE;
+
+	InstanceId instance_id = m_instances.acquire();
+	instance.animation->instance_count++;
+	InsertInstance(instance_id, instance, has_overrides ? &events : nullptr);
+	return instance_id;
+}
+
+// Resolves the template into `instance` and merges the template callbacks into
+// `events`. Returns whether the instance overrides any callback.
+bool AnimationWorld::PrepareInstance(AnimationId id, AnimationEvents& events, AnimationInstance& instance) {
+
+	Animation* animation = m_animations.get(id);
+	if (!animation) throw std::out_of_range("AttachAnimation: invalid animation id");
+	if (animation->removed) throw std::out_of_range("AttachAnimation: animation was removed");
+
+	instance.animation = animation;
+	instance.easing = animation->easing;
+
+	bool has_overrides = events.onStart || events.onEachRepeatStart || events.onUpdate || events.onEachRepeatEnd || events.onEnd;
+
+	if (has_overrides) {
+		const AnimationEvents& de = animation->events;
+
+		if (!events.onStart) events.onStart = de.onStart;
+		if (!events.onEachRepeatStart) events.onEachRepeatStart = de.onEachRepeatStart;
+		if (!events.onUpdate && !de.onUpdateBatch) events.onUpdate = de.onUpdate;
+		if (!events.onEachRepeatEnd) events.onEachRepeatEnd = de.onEachRepeatEnd;
+		if (!events.onEnd) events.onEnd = de.onEnd;
+	}
+
+	return has_overrides;
+}
+
+size_t AnimationWorld::AttachAnimationBatch(AnimationId id, void* const* objs, size_t count, float duration, size_t repeat, AnimationEvents events, InstanceId* ids) {
+	return AttachBatch(id, objs, count, &duration, 0, repeat, events, ids);
+}
+
+size_t AnimationWorld::AttachAnimationBatch(AnimationId id, void* const* objs, size_t count, const float* durations, size_t repeat, AnimationEvents events, InstanceId* ids) {
+	return AttachBatch(id, objs, count, durations, 1, repeat, events, ids);
+}
+
+size_t AnimationWorld::AttachBatch(AnimationId id, void* const* objs, size_t count, const float* durations, size_t stride, size_t repeat, AnimationEvents& events, InstanceId* ids) {
+
+	// Attaches from callbacks are queued one by one.
+	if (DeferredScratch()) {
+		size_t attached = 0;
+		for (size_t k = 0; k < count; ++k) {
+			InstanceId instance_id = AttachAnimation(id, objs[k], durations[k * stride], repeat, events);
+			if (ids) ids[k] = instance_id;
+			if (instance_id.slot_index != ANIM_INVALID_INSTANCE.slot_index) attached++;
+		}
+		return attached;
+	}
+
+	AnimationInstance instance;
+	instance.repeat = repeat;
+
+	bool has_overrides = PrepareInstance(id, events, instance);
+
+	size_t attached = std::min(count, m_instances.available());
+	size_t first = m_instances.size();
+
+	m_instances.insert_batch(instance, objs, durations, stride, attached, has_overrides ? &events : nullptr, ids);
+	instance.animation->instance_count += attached;
+
+	std::fill(m_instances.rate.begin() + first, m_instances.rate.end(), m_group_scale[0]);
+	if (!(m_frozen & 1u)) {
+		for (size_t k = 0; k < attached; ++k) m_instances.unpark((uint32_t)(first + k));
+	}
+	if (ids) std::fill(ids + attached, ids + count, ANIM_INVALID_INSTANCE);
+
+	return attached;
+}
+
+// The instance must already be counted on its template.
+void AnimationWorld::InsertInstance(InstanceId id, const AnimationInstance& instance, const AnimationEvents* overrides) {
+	m_instances.insert(id, instance, overrides);
+
+	uint32_t index = m_instances.index_of(id);
+	m_instances.rate[index] = m_group_scale[0];
+
+	if (instance.delay > 0.0f) SleepInstance(index, instance.delay);
+	else if (!Frozen(index)) m_instances.unpark(index);
+}
+
+void AnimationWorld::ReleaseInstance(size_t index) {
+	Animation* animation = m_instances.animation[index];
+	m_instances.erase(m_instances.get_handle_at(index));
+
+	if (--animation->instance_count == 0 && animation->removed) EraseAnimation(animation);
+}
+
+// Step templates of a timeline are pinned by it, so erasing a timeline may free
+// steps that were removed in the meantime.
+void AnimationWorld::EraseAnimation(Animation* animation) {
+	for (const auto& entry : animation->timeline) {
+		Animation* step = entry.animation;
+		if (--step->instance_count == 0 && step->removed) EraseAnimation(step);
+	}
+
+	m_animations.erase(animation->id);
+}
+
+void AnimationWorld::SleepInstance(uint32_t index, float seconds) {
+	uint64_t tick = (uint64_t)std::ceil((m_clock + seconds) * TICKS_PER_SECOND);
+
+	index = m_instances.park(index);
+	m_instances.wake[index] = tick;
+	m_wheel.schedule(m_instances.get_handle_at(index), tick);
+}
+
+void AnimationWorld::WakeInstances() {
+
+	m_wheel.advance((uint64_t)(m_clock * TICKS_PER_SECOND), m_due);
+
+	for (const auto& entry : m_due) {
+		if (!m_instances.is_valid(entry.id)) continue;
+
+		uint32_t i = m_instances.index_of(entry.id);
+		if (!m_instances.parked(i) || m_instances.wake[i] != entry.tick) continue;
+
+		// Paused or frozen while waiting: Continue or Unfreeze will unpark it.
+		if (m_instances.state[i] == ANIM_PAUSED || Frozen(i)) {
+			m_instances.wake[i] = 0;
+			continue;
+		}
+
+		i = m_instances.unpark(i);
+
+		// Start from the overshoot past the wake time, minus the step this frame adds.
+		m_instances.time[i] = ((float)(m_clock - entry.tick / TICKS_PER_SECOND) - m_frame_dt) * m_instances.rate[i];
+	}
+
+	m_due.clear();
+}
+
+void AnimationWorld::ThawGroups(float dt) {
+	uint32_t thawed = 0;
+
+	for (uint32_t g = 0; g < ANIM_GROUP_COUNT; ++g) {
+		if (!((m_frozen >> g) & 1u)) continue;
+		m_thaw[g] -= dt;
+		if (m_thaw[g] <= 0.0f) thawed |= 1u << g;
+	}
+
+	if (thawed) ApplyUnfreeze(thawed);
+}
+
+bool AnimationWorld::Waiting(uint32_t i) const {
+	AnimationState state = m_instances.state[i];
+	if (state == ANIM_PAUSED) return true;
+	return (state == ANIM_STARTING || state == ANIM_SLEEPING) && m_instances.wake[i] > m_wheel.now();
+}
+
+void AnimationWorld::ApplyGroupScale(uint32_t group, float scale) {
+	if (group >= ANIM_GROUP_COUNT) return;
+	m_group_scale[group] = scale;
+
+	for (size_t i = 0; i < m_instances.size(); ++i) {
+		if (m_instances.group[i] == group) m_instances.rate[i] = m_instances.speed[i] * scale;
+	}
+}
+
+void AnimationWorld::ApplyFreeze(uint32_t groups, float seconds) {
+	uint32_t added = groups & ~m_frozen;
+
+	for (uint32_t g = 0; g < ANIM_GROUP_COUNT; ++g) {
+		if ((groups >> g) & 1u) m_thaw[g] = seconds;
+	}
+
+	m_frozen |= groups;
+	if (!added) return;
+
+	// Parking swaps the last active instance into i, so i is checked again.
+	for (uint32_t i = 0; i < m_instances.active(); ) {
+		if ((added >> m_instances.group[i]) & 1u) m_instances.park(i);
+		else ++i;
+	}
+}
+
+void AnimationWorld::ApplyUnfreeze(uint32_t groups) {
+	uint32_t removed = groups & m_frozen;
+	m_frozen &= ~groups;
+	if (!removed) return;
+
+	// Unparking swaps i with the first parked instance, which was already checked.
+	for (uint32_t i = (uint32_t)m_instances.active(); i < m_instances.size(); ++i) {
+		if (((removed >> m_instances.group[i]) & 1u) && !Waiting(i)) m_instances.unpark(i);
+	}
+}
+
+_WorkerScratch* AnimationWorld::DeferredScratch() {
+	if (!m_deferring) return nullptr;
+	return &m_scratch[s_current_world == this ? s_current_worker : 0];
+}
+
+void AnimationWorld::Submit(_AnimationCommand::Type type, InstanceId id, uint32_t arg) {
+	_AnimationCommand command;
+	command.type = type;
+	command.id = id;
+	command.arg = arg;
+
+	if (_WorkerScratch* scratch = DeferredScratch()) scratch->commands.push_back(command);
+	else Apply(command);
+}
+
+void AnimationWorld::SubmitTagged(_AnimationCommand::Type type, uint32_t tags) {
+	if (tags == 0) return;
+
+	_AnimationCommand command;
+	command.type = type;
+	command.tags = tags;
+
+	if (_WorkerScratch* scratch = DeferredScratch()) scratch->commands.push_back(command);
+	else Apply(command);
+}
+
+void AnimationWorld::SubmitWorld(_AnimationCommand::Type type, uint32_t arg, float value) {
+	_AnimationCommand command;
+	command.type = type;
+	command.arg = arg;
+	command.value = value;
+
+	if (_WorkerScratch* scratch = DeferredScratch()) scratch->commands.push_back(command);
+	else Apply(command);
+}
+
+// Each id is looked up and controlled on its own row, so the cost follows the
+// number of ids rather than the size of the pool.
+void AnimationWorld::SubmitMany(_AnimationCommand::Type type, const InstanceId* ids, size_t count) {
+	for (size_t k = 0; k < count; ++k) Submit(type, ids[k]);
+}
+
+// Walks the pool once. Pausing an active instance swaps an unvisited one into
+// its place, so that index is visited again; every other control only moves
+// instances into the active prefix, behind the cursor.
+template <typename Selected>
+void AnimationWorld::ApplySelected(_AnimationCommand::Type type, Selected selected) {
+	for (uint32_t i = 0; i < m_instances.size(); ) {
+		if (!selected(i)) {
+			++i;
+			continue;
+		}
+
+		bool revisit = type == _AnimationCommand::CMD_PAUSE && !m_instances.parked(i);
+		ApplyAt(type, i, 0);
+		if (!revisit) ++i;
+	}
+}
+
+void AnimationWorld::Apply(const _AnimationCommand& command) {
+
+	switch (command.type) {
+		case _AnimationCommand::CMD_SET_TIME_SCALE: m_time_scale = command.value; return;
+		case _AnimationCommand::CMD_SET_GROUP_SCALE: ApplyGroupScale(command.arg, command.value); return;
+		case _AnimationCommand::CMD_FREEZE: ApplyFreeze(command.arg, command.value); return;
+		case _AnimationCommand::CMD_UNFREEZE: ApplyUnfreeze(command.arg); return;
+		default: break;
+	}
+
+	if (command.tags != 0) {
+		ApplySelected(command.type, [this, &command](uint32_t i) { return (m_instances.tags[i] & command.tags) != 0; });
+		return;
+	}
+
+	if (!m_instances.is_valid(command.id)) return;
+
+	uint32_t i = m_instances.index_of(command.id);
+
+	switch (command.type) {
+		case _AnimationCommand::CMD_SET_SPEED:
+			m_instances.speed[i] = command.value;
+			m_instances.rate[i] = command.value * m_group_scale[m_instances.group[i]];
+			break;
+		case _AnimationCommand::CMD_SET_GROUP: {
+			if (command.arg >= ANIM_GROUP_COUNT) break;
+			bool was_frozen = Frozen(i);
+			m_instances.group[i] = (uint8_t)command.arg;
+			m_instances.rate[i] = m_instances.speed[i] * m_group_scale[command.arg];
+			if (!was_frozen && Frozen(i)) m_instances.park(i);
+			else if (was_frozen && !Frozen(i) && !Waiting(i)) m_instances.unpark(i);
+			break;
+		}
+		default: ApplyAt(command.type, i, command.arg); break;
+	}
+}
+
+void AnimationWorld::ApplyAt(_AnimationCommand::Type type, uint32_t i, uint32_t arg) {
+
+	switch (type) {
+		case _AnimationCommand::CMD_ATTACH: break;
+		case _AnimationCommand::CMD_RELEASE: ReleaseInstance(i); break;
+		case _AnimationCommand::CMD_PAUSE:
+			if (m_instances.state[i] == ANIM_PAUSED) break;
+			i = m_instances.park(i);
+			m_instances.resume[i] = m_instances.state[i];
+			m_instances.state[i] = ANIM_PAUSED;
+			break;
+		case _AnimationCommand::CMD_STOP:
+			i = m_instances.unpark(i);
+			m_instances.state[i] = ANIM_STOPPING;
+			break;
+		case _AnimationCommand::CMD_CONTINUE: {
+			if (m_instances.state[i] != ANIM_PAUSED) break;
+			AnimationState state = m_instances.resume[i];
+			m_instances.state[i] = state;
+			// An instance paused during a delay keeps waiting until its wake time.
+			if (!Waiting(i) && !Frozen(i)) m_instances.unpark(i);
+			break;
+		}
+		case _AnimationCommand::CMD_RESTART:
+			if (!Frozen(i)) i = m_instances.unpark(i);
+			m_instances.state[i] = ANIM_STARTING;
+			m_instances.wake[i] = 0;
+			m_instances.time[i] = 0.0f;
+			m_instances.repeat_count[i] = 0;
+			m_instances.reversed[i] = m_instances.direction[i] == ANIM_REVERSE;
+			m_instances.cursor[i] = NAN;
+			m_instances.segment[i] = UINT32_MAX;
+			break;
+		case _AnimationCommand::CMD_SET_EASING: m_instances.easing[i] = (AnimationEasing)arg; break;
+		case _AnimationCommand::CMD_SET_DIRECTION: {
+			AnimationDirection direction = (AnimationDirection)arg;
+			bool was_reversed = m_instances.reversed[i] != 0;
+			bool reversed = direction == ANIM_REVERSE || (direction == ANIM_PINGPONG && was_reversed);
+			AnimationState state = m_instances.state[i] == ANIM_PAUSED ? m_instances.resume[i] : m_instances.state[i];
+			m_instances.direction[i] = direction;
+			m_instances.reversed[i] = reversed;
+			if (state == ANIM_RUNNING && reversed != was_reversed) m_instances.time[i] = m_instances.duration[i] - m_instances.time[i];
+			break;
+		}
+		case _AnimationCommand::CMD_SET_TAGS: m_instances.tags[i] = arg; break;
+		case _AnimationCommand::CMD_SLEEP: {
+			AnimationState state = m_instances.state[i] == ANIM_PAUSED ? m_instances.resume[i] : m_instances.state[i];
+			if (state == ANIM_SLEEPING) SleepInstance(i, m_instances.repeat_delay[i]);
+			break;
+		}
+		default: break;
+	}
+}
+
+void AnimationWorld::FlushCommands() {
+
+	for (auto& scratch : m_scratch) {
+		for (auto& command : scratch.commands) {
+			if (command.index != UINT32_MAX) command.id = m_instances.get_handle_at(command.index);
+		}
+	}
+
+	for (auto& scratch : m_scratch) {
+		for (const auto& command : scratch.commands) {
+			if (command.type != _AnimationCommand::CMD_ATTACH) continue;
+			InsertInstance(command.id, command.instance, command.events != UINT32_MAX ? &scratch.events[command.events] : nullptr);
+		}
+	}
+
+	for (auto& scratch : m_scratch) {
+		for (const auto& command : scratch.commands) {
+			if (command.type != _AnimationCommand::CMD_ATTACH) Apply(command);
+		}
+		scratch.commands.clear();
+		scratch.events.clear();
+	}
+}
+
+void AnimationWorld::UpdateRange(size_t begin, size_t end, _WorkerScratch& scratch) {
+	auto& pool = m_instances;
+	float dt = m_frame_dt;
+
+	scratch.progress.resize(end - begin);
+	float* progress = scratch.progress.data() - begin;
+
+	for (size_t i = begin; i < end; ++i) {
+		float time = pool.time[i] + dt * pool.rate[i];
+		float duration = pool.duration[i];
+		time = time > duration ? duration : time;
+		pool.time[i] = time;
+		progress[i] = pool.reversed[i] ? 1.0f - time / duration : time / duration;
+	}
+
+	for (size_t i = begin; i < end; ) {
+		AnimationEasing easing = pool.easing[i];
+		size_t run = i + 1;
+		while (run < end && pool.easing[run] == easing) ++run;
+		if (easing == EASE_CUBIC_BEZIER) {
+			for (size_t k = i; k < run; ++k) progress[k] = pool.animation[k]->ease(easing, progress[k]);
+		} else if (easing != EASE_LINEAR) {
+			EaseBatch(easing, progress + i, progress + i, run - i);
+		}
+		i = run;
+	}
+
+	for (size_t i = begin; i < end; ++i) {
+
+		const AnimationEvents& events = pool.events(i);
+
+		// Paused instances are parked, so everything here is running apart from
+		// the first frame after a start, stop or wake.
+		if (pool.state[i] != ANIM_RUNNING) {
+
+			if (pool.state[i] == ANIM_STOPPING) {
+				if (events.onEnd) events.onEnd();
+				scratch.commands.push_back({ _AnimationCommand::CMD_RELEASE, { }, (uint32_t)i });
+				continue;
+			}
+
+			if (pool.state[i] == ANIM_STARTING && events.onStart) events.onStart();
+			if (events.onEachRepeatStart) events.onEachRepeatStart(pool.obj[i]);
+			pool.state[i] = ANIM_RUNNING;
+		}
+
+		const Animation& animation = *pool.animation[i];
+		if (!animation.key_times.empty()) progress[i] = SampleKeyframes(animation, pool.segment[i], progress[i]);
+
+		if (pool.batched(i)) {
+			scratch.batch_animations.push_back(pool.animation[i]);
+			scratch.batch_progress.push_back(progress[i]);
+			scratch.batch_objs.push_back(pool.obj[i]);
+		} else if (events.onUpdate) {
+			events.onUpdate(progress[i], pool.obj[i]);
+		}
+
+		if (!animation.timeline.empty()) EvaluateTimeline(animation, pool.cursor[i], progress[i], pool.reversed[i], pool.obj[i]);
+
+		if (pool.time[i] == pool.duration[i]) scratch.cycle_ends.push_back((uint32_t)i);
+	}
+}
+
+void AnimationWorld::EndCycles(_WorkerScratch& scratch) {
+	auto& pool = m_instances;
+
+	for (uint32_t i : scratch.cycle_ends) {
+
+		const AnimationEvents& events = pool.events(i);
+
+		pool.repeat_count[i]++;
+		
+		if (events.onEachRepeatEnd) events.onEachRepeatEnd(pool.obj[i]);
+		pool.time[i] = 0.0f;
+		if (pool.direction[i] == ANIM_PINGPONG) pool.reversed[i] ^= 1;
+		pool.cursor[i] = NAN;
+
+		if (pool.repeat[i] > 0 && pool.repeat_count[i] == pool.repeat[i]) {
+			pool.state[i] = ANIM_FINISHED;
+			if (events.onEnd) events.onEnd();
+			scratch.commands.push_back({ _AnimationCommand::CMD_RELEASE, { }, i });
+		} else if (pool.repeat_delay[i] > 0.0f) {
+			pool.state[i] = ANIM_SLEEPING;
+			scratch.commands.push_back({ _AnimationCommand::CMD_SLEEP, { }, i });
+		} else {
+			if (events.onEachRepeatStart) events.onEachRepeatStart(pool.obj[i]);
+		}
+	}
+
+	scratch.cycle_ends.clear();
+}
+
+void AnimationWorld::RunUpdateChunk(void* context, size_t task, size_t worker) {
+	AnimationWorld* world = static_cast<AnimationWorld*>(context);
+	s_current_world = world;
+	s_current_worker = worker;
+
+	size_t begin = task * world->m_chunk_size;
+	size_t end = std::min(begin + world->m_chunk_size, world->m_frame_count);
+	world->UpdateRange(begin, end, world->m_scratch[worker]);
+}
+
+void AnimationWorld::RunEndCycles(void* context, size_t task, size_t worker) {
+	AnimationWorld* world = static_cast<AnimationWorld*>(context);
+	s_current_world = world;
+
+	// Callbacks queue into the buffer of the task being ended, not the one of
+	// the running worker, so a stolen task never shares a buffer with another.
+	s_current_worker = task;
+	world->EndCycles(world->m_scratch[task]);
+	s_current_worker = worker;
+}
+
+void AnimationWorld::UpdateAnimations(float dt) {
+
+	m_frame_dt = dt * m_time_scale;
+	m_clock += m_frame_dt;
+	if (m_frozen) ThawGroups(dt);
+	WakeInstances();
+
+	m_frame_count = m_instances.active();
+	m_deferring = true;
+
+	if (m_workers) {
+		m_workers->run((m_frame_count + m_chunk_size - 1) / m_chunk_size, &RunUpdateChunk, this);
+	} else {
+		UpdateRange(0, m_frame_count, m_scratch[0]);
+	}
+
+	for (auto& scratch : m_scratch) {
+		for (size_t k = 0; k < scratch.batch_animations.size(); ++k) {
+			Animation* animation = scratch.batch_animations[k];
+			if (animation->batch_progress.empty()) m_batched_animations.push_back(animation);
+			animation->batch_progress.push_back(scratch.batch_progress[k]);
+			animation->batch_objs.push_back(scratch.batch_objs[k]);
+		}
+		scratch.batch_animations.clear();
+		scratch.batch_progress.clear();
+		scratch.batch_objs.clear();
+	}
+
+	for (Animation* animation : m_batched_animations) {
+		animation->events.onUpdateBatch(animation->batch_progress.data(), animation->batch_objs.data(), animation->batch_progress.size());
+		animation->batch_progress.clear();
+		animation->batch_objs.clear();
+	}
+
+	m_batched_animations.clear();
+
+	if (m_workers) m_workers->run(m_scratch.size(), &RunEndCycles, this);
+	else EndCycles(m_scratch[0]);
+
+	m_deferring = false;
+	FlushCommands();
+
+	// Callbacks of these pools may create pools of new types, which grows the
+	// pool lists. They are walked by index up to their size at the start, so
+	// a pool created here first updates on the next frame.
+	size_t typed_count = m_typed_pools.size();
+	size_t tween_count = m_tween_pools.size();
+	size_t spring_count = m_spring_pools.size();
+
+	for (size_t p = 0; p < typed_count; ++p) m_typed_pools[p]->update(m_frame_dt);
+
+	for (size_t p = 0; p < tween_count; ++p) {
+		if (m_tween_pools[p]) m_tween_pools[p]->update(m_frame_dt);
+	}
+
+	for (size_t p = 0; p < spring_count; ++p) {
+		if (m_spring_pools[p]) m_spring_pools[p]->update(m_frame_dt);
+	}
+}
+
+void AnimationWorld::Reserve(size_t instances, bool hard_capacity) {
+	m_instances.reserve(instances, hard_capacity);
+	m_wheel.reserve(instances);
+	m_due.reserve(instances);
+}
+
+void AnimationWorld::SetWorkerCount(size_t workers, size_t chunk_size) {
+	m_workers = workers > 0 ? _MakeOwned<_WorkerPool>(m_resource, workers, m_resource) : nullptr;
+	m_scratch.clear();
+	for (size_t i = 0; i <= workers; ++i) m_scratch.emplace_back(m_resource);
+	m_chunk_size = chunk_size > 0 ? chunk_size : 1;
+}
+
+bool AnimationWorld::HasAnimation(AnimationId id) {
+	Animation* animation = m_animations.get(id);
+	return animation && !animation->removed;
+}
+
+void AnimationWorld::RemoveAnimation(AnimationId id) {
+	Animation* animation = m_animations.get(id);
+	if (!animation) return;
+
+	if (animation->instance_count == 0) EraseAnimation(animation);
+	else animation->removed = true;
+}
+
+void AnimationWorld::ClearAnimations() {
+	for (size_t i = m_animations.size(); i-- > 0; ) {
+		// Erasing a timeline can erase its steps too, shrinking the range.
+		if (i >= m_animations.size()) continue;
+
+		Animation* animation = m_animations.get(m_animations.get_handle_at(i));
+
+		if (animation->instance_count == 0) EraseAnimation(animation);
+		else animation->removed = true;
+	}
+}
+
+void AnimationWorld::Pause(InstanceId id) {
+	Submit(_AnimationCommand::CMD_PAUSE, id);
+}
+
+void AnimationWorld::Stop(InstanceId id) {
+	Submit(_AnimationCommand::CMD_STOP, id);
+}
+
+void AnimationWorld::Continue(InstanceId id) {
+	Submit(_AnimationCommand::CMD_CONTINUE, id);
+}
+
+void AnimationWorld::Restart(InstanceId id) {
+	Submit(_AnimationCommand::CMD_RESTART, id);
+}
+
+void AnimationWorld::SetEasing(InstanceId id, AnimationEasing easing) {
+	Submit(_AnimationCommand::CMD_SET_EASING, id, easing);
+}
+
+void AnimationWorld::SetDirection(InstanceId id, AnimationDirection direction) {
+	Submit(_AnimationCommand::CMD_SET_DIRECTION, id, direction);
+}
+
+void AnimationWorld::Pause(const InstanceId* ids, size_t count) {
+	SubmitMany(_AnimationCommand::CMD_PAUSE, ids, count);
+}
+
+void AnimationWorld::Stop(const InstanceId* ids, size_t count) {
+	SubmitMany(_AnimationCommand::CMD_STOP, ids, count);
+}
+
+void AnimationWorld::Continue(const InstanceId* ids, size_t count) {
+	SubmitMany(_AnimationCommand::CMD_CONTINUE, ids, count);
+}
+
+void AnimationWorld::Restart(const InstanceId* ids, size_t count) {
+	SubmitMany(_AnimationCommand::CMD_RESTART, ids, count);
+}
+
+void AnimationWorld::SetTags(InstanceId id, uint32_t tags) {
+	Submit(_AnimationCommand::CMD_SET_TAGS, id, tags);
+}
+
+void AnimationWorld::PauseAll(uint32_t tags) {
+	SubmitTagged(_AnimationCommand::CMD_PAUSE, tags);
+}
+
+void AnimationWorld::StopAll(uint32_t tags) {
+	SubmitTagged(_AnimationCommand::CMD_STOP, tags);
+}
+
+void AnimationWorld::ContinueAll(uint32_t tags) {
+	SubmitTagged(_AnimationCommand::CMD_CONTINUE, tags);
+}
+
+void AnimationWorld::RestartAll(uint32_t tags) {
+	SubmitTagged(_AnimationCommand::CMD_RESTART, tags);
+}
+
+void AnimationWorld::SetTimeScale(float scale) {
+	SubmitWorld(_AnimationCommand::CMD_SET_TIME_SCALE, 0, std::max(scale, 0.0f));
+}
+
+void AnimationWorld::SetSpeed(InstanceId id, float speed) {
+	_AnimationCommand command;
+	command.type = _AnimationCommand::CMD_SET_SPEED;
+	command.id = id;
+	command.value = std::max(speed, 0.0f);
+
+	if (_WorkerScratch* scratch = DeferredScratch()) scratch->commands.push_back(command);
+	else Apply(command);
+}
+
+void AnimationWorld::SetGroup(InstanceId id, uint32_t group) {
+	Submit(_AnimationCommand::CMD_SET_GROUP, id, group);
+}
+
+void AnimationWorld::SetGroupScale(uint32_t group, float scale) {
+	SubmitWorld(_AnimationCommand::CMD_SET_GROUP_SCALE, group, std::max(scale, 0.0f));
+}
+
+void AnimationWorld::Freeze(uint32_t groups) {
+	SubmitWorld(_AnimationCommand::CMD_FREEZE, groups, INFINITY);
+}
+
+void AnimationWorld::Unfreeze(uint32_t groups) {
+	SubmitWorld(_AnimationCommand::CMD_UNFREEZE, groups, 0.0f);
+}
+
+void AnimationWorld::Hitstop(uint32_t groups, float seconds) {
+	SubmitWorld(_AnimationCommand::CMD_FREEZE, groups, seconds);
+}
+
+thread_local AnimationWorld* AnimationWorld::s_current_world = nullptr;
+thread_local size_t AnimationWorld::s_current_worker = 0;
+
+_WorkerPool::_WorkerPool(size_t threads, std::pmr::memory_resource* resource) : m_queues(resource), m_threads(resource) {
+	m_queues.reserve(threads + 1);
+	m_threads.reserve(threads);
+	for (size_t i = 0; i <= threads; ++i) m_queues.push_back(_MakeOwned<Queue>(resource, resource));
+	for (size_t i = 1; i <= threads; ++i) m_threads.emplace_back(&_WorkerPool::thread_main, this, i);
+}
+
+_WorkerPool::~_WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (auto& thread : m_threads) thread.join();
+}
+
+void _WorkerPool::run(size_t tasks, Task task, void* context) {
+
+	if (tasks == 0) return;
+
+	size_t generation;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_task = task;
+		m_context = context;
+		m_remaining = tasks;
+		generation = ++m_generation;
+
+		for (auto& queue : m_queues) {
+			std::lock_guard<std::mutex> queue_lock(queue->mutex);
+			queue->tasks.clear();
+			queue->head = 0;
+			queue->generation = generation;
+		}
+
+		for (size_t i = 0; i < tasks; ++i) {
+			Queue& queue = *m_queues[i % m_queues.size()];
+			std::lock_guard<std::mutex> queue_lock(queue.mutex);
+			queue.tasks.push_back(i);
+		}
+
+		m_busy++;
+	}
+
+	m_wake.notify_all();
+	work(0, generation, task, context);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_busy--;
+	m_done.wait(lock, [this] { return m_remaining == 0 && m_busy == 0; });
+}
+
+void _WorkerPool::work(size_t worker, size_t generation, Task task, void* context) {
+	size_t index;
+	while (pop(worker, generation, index)) {
+		task(context, index, worker);
+		if (--m_remaining == 0) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_done.notify_all();
+		}
+	}
+}
+
+bool _WorkerPool::pop(size_t worker, size_t generation, size_t& task) {
+
+	{
+		Queue& own = *m_queues[worker];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (own.generation == generation && own.head < own.tasks.size()) {
+			task = own.tasks.back();
+			own.tasks.pop_back();
+			return true;
+		}
+	}
+
+	for (size_t k = 1; k < m_queues.size(); ++k) {
+		Queue& victim = *m_queues[(worker + k) % m_queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (victim.generation == generation && victim.head < victim.tasks.size()) {
+			task = victim.tasks[victim.head++];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void _WorkerPool::thread_main(size_t worker) {
+
+	size_t seen = 0;
+
+	for (;;) {
+
+		Task task;
+		void* context;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+			if (m_stop) return;
+
+			seen = m_generation;
+			task = m_task;
+			context = m_context;
+			m_busy++;
+		}
+
+		work(worker, seen, task, context);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_busy--;
+		}
+		m_done.notify_all();
+	}
+}
+
+const AnimationId AnimationHandler::CreateAnimation(AnimationEvents events, AnimationEasing easing) {
+	return s_world.CreateAnimation(events, easing);
+}
+
+const AnimationId AnimationHandler::CreateAnimation(AnimationEvents events, CubicBezier curve) {
+	return s_world.CreateAnimation(events, curve);
+}
+
+const AnimationId AnimationHandler::CreateTimeline(const Timeline& timeline, AnimationEvents events, AnimationEasing easing) {
+	return s_world.CreateTimeline(timeline, events, easing);
+}
+
+const AnimationId AnimationHandler::CreateKeyframes(const Keyframe* keys, size_t count, AnimationEvents events, AnimationEasing easing) {
+	return s_world.CreateKeyframes(keys, count, events, easing);
+}
+
+InstanceId AnimationHandler::AttachAnimation(AnimationId id, void* obj, float duration, size_t repeat, AnimationEvents events, float delay, float repeat_delay) {
+	return s_world.AttachAnimation(id, obj, duration, repeat, events, delay, repeat_delay);
+}
+
+size_t AnimationHandler::AttachAnimationBatch(AnimationId id, void* const* objs, size_t count, float duration, size_t repeat, AnimationEvents events, InstanceId* ids) {
+	return s_world.AttachAnimationBatch(id, objs, count, duration, repeat, events, ids);
+}
+
+size_t AnimationHandler::AttachAnimationBatch(AnimationId id, void* const* objs, size_t count, const float* durations, size_t repeat, AnimationEvents events, InstanceId* ids) {
+	return s_world.AttachAnimationBatch(id, objs, count, durations, repeat, events, ids);
+}
+
+void AnimationHandler::UpdateAnimations(float dt) {
+	s_world.UpdateAnimations(dt);
+}
+
+bool AnimationHandler::HasAnimation(AnimationId id) {
+	return s_world.HasAnimation(id);
+}
+
+void AnimationHandler::RemoveAnimation(AnimationId id) {
+	s_world.RemoveAnimation(id);
+}
+
+void AnimationHandler::ClearAnimations() {
+	s_world.ClearAnimations();
+}
+
+void AnimationHandler::Pause(InstanceId id) {
+	s_world.Pause(id);
+}
+
+void AnimationHandler::Stop(InstanceId id) {
+	s_world.Stop(id);
+}
+
+void AnimationHandler::Continue(InstanceId id) {
+	s_world.Continue(id);
+}
+
+void AnimationHandler::Restart(InstanceId id) {
+	s_world.Restart(id);
+}
+
+void AnimationHandler::SetEasing(InstanceId id, AnimationEasing easing) {
+	s_world.SetEasing(id, easing);
+}
+
+void AnimationHandler::SetDirection(InstanceId id, AnimationDirection direction) {
+	s_world.SetDirection(id, direction);
+}
+
+void AnimationHandler::Pause(const InstanceId* ids, size_t count) {
+	s_world.Pause(ids, count);
+}
+
+void AnimationHandler::Stop(const InstanceId* ids, size_t count) {
+	s_world.Stop(ids, count);
+}
+
+void AnimationHandler::Continue(const InstanceId* ids, size_t count) {
+	s_world.Continue(ids, count);
+}
+
+void AnimationHandler::Restart(const InstanceId* ids, size_t count) {
+	s_world.Restart(ids, count);
+}
+
+void AnimationHandler::SetTags(InstanceId id, uint32_t tags) {
+	s_world.SetTags(id, tags);
+}
+
+void AnimationHandler::PauseAll(uint32_t tags) {
+	s_world.PauseAll(tags);
+}
+
+void AnimationHandler::StopAll(uint32_t tags) {
+	s_world.StopAll(tags);
+}
+
+void AnimationHandler::ContinueAll(uint32_t tags) {
+	s_world.ContinueAll(tags);
+}
+
+void AnimationHandler::RestartAll(uint32_t tags) {
+	s_world.RestartAll(tags);
+}
+
+void AnimationHandler::SetTimeScale(float scale) {
+	s_world.SetTimeScale(scale);
+}
+
+void AnimationHandler::SetSpeed(InstanceId id, float speed) {
+	s_world.SetSpeed(id, speed);
+}
+
+void AnimationHandler::SetGroup(InstanceId id, uint32_t group) {
+	s_world.SetGroup(id, group);
+}
+
+void AnimationHandler::SetGroupScale(uint32_t group, float scale) {
+	s_world.SetGroupScale(group, scale);
+}
+
+void AnimationHandler::Freeze(uint32_t groups) {
+	s_world.Freeze(groups);
+}
+
+void AnimationHandler::Unfreeze(uint32_t groups) {
+	s_world.Unfreeze(groups);
+}
+
+void AnimationHandler::Hitstop(uint32_t groups, float seconds) {
+	s_world.Hitstop(groups, seconds);
+}
+
+void AnimationHandler::Reserve(size_t instances, bool hard_capacity) {
+	s_world.Reserve(instances, hard_capacity);
+}
+
+size_t AnimationHandler::AllocationCount() {
+	return s_world.AllocationCount();
+}
+
+AnimationWorld& AnimationHandler::DefaultWorld() {
+	return s_world;
+}
+
+void AnimationHandler::SetMemoryResource(std::pmr::memory_resource* resource) {
+	s_world.~AnimationWorld();
+	::new (&s_world) AnimationWorld(resource);
+}
 
-_SlotMap<AnimationInstance> AnimationHandler::s_instances;
+AnimationWorld AnimationHandler::s_world;
 
 #ifdef ANIM_NAMESPACE
 }
@@ -0,0 +1,342 @@
+#define ANIMATE_HPP_IMPLEMENTATION
+#include <animate.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+static std::atomic<size_t> g_allocations = { 0 };
+
+void* operator new(size_t size) {
+	g_allocations++;
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// std::pmr::new_delete_resource, behind every AnimationWorld by default, goes
+// through the aligned forms.
+void* operator new(size_t size, std::align_val_t align) {
+	g_allocations++;
+	size_t alignment = (size_t)align;
+	size = (size + alignment - 1) / alignment * alignment;
+#if defined(_WIN32)
+	if (void* p = _aligned_malloc(size ? size : alignment, alignment)) return p;
+#else
+	if (void* p = std::aligned_alloc(alignment, size ? size : alignment)) return p;
+#endif
+	throw std::bad_alloc();
+}
+
+#if defined(_WIN32)
+void operator delete(void* p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { _aligned_free(p); }
+#else
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
+
+static double PeakRssMb() {
+#if defined(__APPLE__)
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / (1024.0 * 1024.0);
+#elif defined(__unix__)
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024.0;
+#else
+	return 0.0;
+#endif
+}
+
+struct Particle {
+	float x = 0.0f;
+	float y = 0.0f;
+	float size = 0.0f;
+};
+
+struct Result {
+	double ns_per_item = 0.0;
+	double allocations_per_frame = 0.0;
+};
+
+using Clock = std::chrono::steady_clock;
+
+static const float FRAME = 1.0f / 60.0f;
+static const int WARMUP_FRAMES = 5;
+
+template <typename Frame>
+static Result Measure(size_t items, int frames, Frame frame) {
+
+	for (int i = 0; i < WARMUP_FRAMES; ++i) frame();
+
+	size_t allocations = g_allocations;
+	auto begin = Clock::now();
+
+	for (int i = 0; i < frames; ++i) frame();
+
+	auto end = Clock::now();
+
+	Result result;
+	result.ns_per_item = std::chrono::duration<double, std::nano>(end - begin).count() / ((double)items * frames);
+	result.allocations_per_frame = (double)(g_allocations - allocations) / frames;
+	return result;
+}
+
+static void Report(const char* scenario, size_t items, Result result) {
+	printf("%-22s %9zu %12.2f %14.2f %12.1f\n", scenario, items, result.ns_per_item, result.allocations_per_frame, PeakRssMb());
+}
+
+static int FramesFor(size_t count) {
+	return count >= 1000000 ? 10 : count >= 100000 ? 30 : 200;
+}
+
+static void BenchUpdate(size_t count) {
+	AnimationWorld world;
+	std::vector<Particle> particles(count);
+
+	AnimationEvents events;
+	events.onUpdate = [](float progress, void* obj) {
+		static_cast<Particle*>(obj)->size = 32.0f * progress;
+	};
+	AnimationId grow = world.CreateAnimation(events);
+
+	for (size_t i = 0; i < count; ++i) world.AttachAnimation(grow, &particles[i], 0.5f + (i % 16) * 0.1f, 0, { });
+
+	Report("update", count, Measure(count, FramesFor(count), [&] { world.UpdateAnimations(FRAME); }));
+}
+
+static void BenchAttach(size_t count) {
+	AnimationWorld world;
+	std::vector<Particle> particles(count);
+	AnimationEvents events;
+	events.onUpdate = [](float, void*) { };
+	AnimationId grow = world.CreateAnimation(events);
+
+	auto begin = Clock::now();
+	size_t allocations = g_allocations;
+
+	for (size_t i = 0; i < count; ++i) world.AttachAnimation(grow, &particles[i], 1.0f, 0, { });
+
+	Result result;
+	result.ns_per_item = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / count;
+	result.allocations_per_frame = (double)(g_allocations - allocations);
+	Report("attach", count, result);
+}
+
+static void BenchAttachBatch(size_t count) {
+	AnimationWorld world;
+	std::vector<Particle> particles(count);
+	std::vector<void*> objs(count);
+	for (size_t i = 0; i < count; ++i) objs[i] = &particles[i];
+	AnimationEvents events;
+	events.onUpdate = [](float, void*) { };
+	AnimationId grow = world.CreateAnimation(events);
+
+	auto begin = Clock::now();
+	size_t allocations = g_allocations;
+
+	world.AttachAnimationBatch(grow, objs.data(), count, 1.0f, 0, { });
+
+	Result result;
+	result.ns_per_item = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / count;
+	result.allocations_per_frame = (double)(g_allocations - allocations);
+	Report("attach batch", count, result);
+}
+
+static void BenchChurn(size_t count) {
+	AnimationWorld world;
+	std::vector<Particle> particles(count);
+	std::vector<InstanceId> ids(count);
+
+	AnimationEvents events;
+	events.onUpdate = [](float progress, void* obj) {
+		static_cast<Particle*>(obj)->size = 32.0f * progress;
+	};
+	AnimationId grow = world.CreateAnimation(events);
+
+	for (size_t i = 0; i < count; ++i) ids[i] = world.AttachAnimation(grow, &particles[i], 1.0f, 0, { });
+
+	size_t cursor = 0;
+	size_t per_frame = count / 20 + 1;
+
+	Report("churn 5%/frame", count, Measure(count, FramesFor(count), [&] {
+		for (size_t k = 0; k < per_frame; ++k, cursor = (cursor + 1) % count) {
+			world.Stop(ids[cursor]);
+			ids[cursor] = world.AttachAnimation(grow, &particles[cursor], 1.0f, 0, { });
+		}
+		world.UpdateAnimations(FRAME);
+	}));
+}
+
+static void BenchMixedRepeats(size_t count) {
+	AnimationWorld world;
+	std::vector<Particle> particles(count);
+
+	AnimationEvents events;
+	events.onUpdate = [](float progress, void* obj) {
+		static_cast<Particle*>(obj)->x = progress;
+	};
+	AnimationId blink = world.CreateAnimation(events);
+
+	struct Context { AnimationWorld* world; AnimationId id; } context = { &world, blink };
+
+	for (size_t i = 0; i < count; ++i) {
+		Particle* particle = &particles[i];
+		AnimationEvents chain;
+		chain.onEnd = [ctx = &context, particle]() {
+			ctx->world->AttachAnimation(ctx->id, particle, 0.25f, 1 + (size_t)(particle->x * 3), { });
+		};
+		world.AttachAnimation(blink, particle, 0.1f + (i % 8) * 0.05f, i % 4, chain);
+	}
+
+	Report("mixed repeats", count, Measure(count, FramesFor(count), [&] { world.UpdateAnimations(FRAME); }));
+}
+
+static void BenchCallbackHeavy(size_t count) {
+	AnimationWorld world;
+	std::vector<Particle> particles(count);
+	size_t starts = 0;
+	size_t ends = 0;
+
+	AnimationEvents events;
+	events.onStart = [&starts]() { starts++; };
+	events.onEachRepeatStart = [](void* obj) { static_cast<Particle*>(obj)->y = 0.0f; };
+	events.onUpdate = [](float progress, void* obj) { static_cast<Particle*>(obj)->y = progress; };
+	events.onEachRepeatEnd = [](void* obj) { static_cast<Particle*>(obj)->y = 1.0f; };
+	events.onEnd = [&ends]() { ends++; };
+	AnimationId full = world.CreateAnimation(events);
+
+	AnimationEvents overrides;
+	overrides.onEachRepeatEnd = [](void* obj) { static_cast<Particle*>(obj)->size += 1.0f; };
+
+	for (size_t i = 0; i < count; ++i) world.AttachAnimation(full, &particles[i], 0.2f + (i % 10) * 0.02f, 0, overrides);
+
+	Report("callback heavy", count, Measure(count, FramesFor(count), [&] { world.UpdateAnimations(FRAME); }));
+}
+
+static void BenchBatch(size_t count) {
+	AnimationWorld world;
+	std::vector<Particle> particles(count);
+
+	AnimationEvents events;
+	events.onUpdateBatch = [](const float* progress, void* const* objs, size_t n) {
+		for (size_t i = 0; i < n; ++i) static_cast<Particle*>(objs[i])->size = 32.0f * progress[i];
+	};
+	AnimationId grow = world.CreateAnimation(events, EASE_OUT_CUBIC);
+
+	for (size_t i = 0; i < count; ++i) world.AttachAnimation(grow, &particles[i], 0.5f + (i % 16) * 0.1f, 0, { });
+
+	Report("batch + easing", count, Measure(count, FramesFor(count), [&] { world.UpdateAnimations(FRAME); }));
+}
+
+static void BenchTyped(size_t count) {
+	AnimationWorld world;
+	std::vector<Particle> particles(count);
+
+	auto grow = world.CreateTypedAnimation<Particle>([](float progress, Particle& particle) {
+		particle.size = 32.0f * progress;
+	});
+
+	for (size_t i = 0; i < count; ++i) grow.Attach(&particles[i], 0.5f + (i % 16) * 0.1f, 0);
+
+	Report("typed", count, Measure(count, FramesFor(count), [&] { world.UpdateAnimations(FRAME); }));
+}
+
+static void BenchTween(size_t count) {
+	AnimationWorld world;
+	std::vector<Particle> particles(count);
+
+	for (size_t i = 0; i < count; ++i) world.Tween(&particles[i].x, 0.0f, 100.0f, 0.5f + (i % 16) * 0.1f, EASE_IN_OUT_QUAD, 0);
+
+	Report("tween float", count, Measure(count, FramesFor(count), [&] { world.UpdateAnimations(FRAME); }));
+}
+
+static void BenchSpring(size_t count) {
+	AnimationWorld world;
+	std::vector<Particle> particles(count);
+	std::vector<SpringId<float>> springs(count);
+
+	for (size_t i = 0; i < count; ++i) springs[i] = world.Spring(&particles[i].x, 100.0f, { 120.0f + (i % 16) * 10.0f, 8.0f });
+
+	// Every spring gets a new goal every frame, as a UI following the cursor would.
+	float goal = 100.0f;
+	Report("spring retarget", count, Measure(count, FramesFor(count), [&] {
+		goal = -goal;
+		for (size_t i = 0; i < count; ++i) world.SetSpringTarget(springs[i], goal);
+		world.UpdateAnimations(FRAME);
+	}));
+}
+
+static void BenchDelayed(size_t count) {
+	AnimationWorld world;
+	std::vector<Particle> particles(count);
+
+	AnimationEvents events;
+	events.onUpdate = [](float progress, void* obj) {
+		static_cast<Particle*>(obj)->size = 32.0f * progress;
+	};
+	AnimationId grow = world.CreateAnimation(events);
+
+	// Nine in ten instances wait on a start delay longer than the run.
+	for (size_t i = 0; i < count; ++i) {
+		float delay = i % 10 == 0 ? 0.0f : 3600.0f;
+		world.AttachAnimation(grow, &particles[i], 0.5f + (i % 16) * 0.1f, 0, { }, delay);
+	}
+
+	Report("delayed 90%", count, Measure(count, FramesFor(count), [&] { world.UpdateAnimations(FRAME); }));
+}
+
+static void BenchParallel(size_t count) {
+	size_t workers = std::thread::hardware_concurrency();
+	workers = workers > 1 ? workers - 1 : 1;
+
+	AnimationWorld world;
+	world.SetWorkerCount(workers);
+	std::vector<Particle> particles(count);
+
+	AnimationEvents events;
+	events.onUpdate = [](float progress, void* obj) {
+		static_cast<Particle*>(obj)->size = 32.0f * progress;
+	};
+	AnimationId grow = world.CreateAnimation(events);
+
+	for (size_t i = 0; i < count; ++i) world.AttachAnimation(grow, &particles[i], 0.5f + (i % 16) * 0.1f, 0, { });
+
+	Report("update parallel", count, Measure(count, FramesFor(count), [&] { world.UpdateAnimations(FRAME); }));
+}
+
+int main(int argc, char** argv) {
+
+	size_t max_count = argc > 1 ? (size_t)std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+	printf("%-22s %9s %12s %14s %12s\n", "scenario", "count", "ns/item", "allocs/frame", "peak RSS MB");
+
+	for (size_t count = 1000; count <= max_count; count *= 10) {
+		BenchUpdate(count);
+		BenchAttach(count);
+		BenchAttachBatch(count);
+		BenchChurn(count);
+		BenchMixedRepeats(count);
+		BenchCallbackHeavy(count);
+		BenchBatch(count);
+		BenchTyped(count);
+		BenchTween(count);
+		BenchSpring(count);
+		BenchDelayed(count);
+		BenchParallel(count);
+		printf("\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,608 @@
+#define ANIMATE_HPP_IMPLEMENTATION
+#include <animate.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+// Headless checks of the behaviour the raylib demo cannot cover. Runs on every
+// platform and returns non-zero if any check fails.
+
+static int g_failures = 0;
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			g_failures++; \
+		} \
+	} while (0)
+
+static bool Near(float a, float b, float tolerance = 1e-3f) {
+	return std::fabs(a - b) <= tolerance;
+}
+
+// Two-float type tweened and sprung only by this test, so its pools are
+// created on demand from inside callbacks.
+struct Pair {
+	float a;
+	float b;
+};
+
+template <>
+struct _TweenTraits<Pair> {
+	static Pair Lerp(Pair x, Pair y, float t) { return { x.a + (y.a - x.a) * t, x.b + (y.b - x.b) * t }; }
+};
+
+template <>
+struct _SpringTraits<Pair> {
+	static constexpr size_t CHANNELS = 2;
+};
+
+struct Triple {
+	float a;
+	float b;
+	float c;
+};
+
+template <>
+struct _SpringTraits<Triple> {
+	static constexpr size_t CHANNELS = 3;
+};
+
+static AnimationEvents Recorder() {
+	AnimationEvents events;
+	events.onUpdate = [](float progress, void* obj) { *static_cast<float*>(obj) = progress; };
+	return events;
+}
+
+static void TestDelays() {
+	AnimationWorld world;
+	AnimationId id = world.CreateAnimation(Recorder());
+
+	int frame = 0;
+	int started = -1;
+	float progress = -1.0f;
+
+	AnimationEvents events;
+	events.onStart = [&started, &frame]() { started = frame; };
+	world.AttachAnimation(id, &progress, 1.0f, 1, events, 0.5f);
+
+	for (frame = 1; frame <= 10; ++frame) world.UpdateAnimations(0.125f);
+
+	// 0.5 s of delay at 0.125 s per frame wakes on the fourth update.
+	CHECK(started == 4);
+	CHECK(progress > 0.0f && progress < 1.0f);
+}
+
+// A template removed in the frame an attach to it was queued stays alive until
+// that instance ends, so its slot is not reused by the next template.
+static void TestDeferredAttach() {
+	AnimationWorld world;
+
+	int hits_a = 0;
+	int hits_b = 0;
+
+	AnimationEvents a_events;
+	a_events.onUpdate = [&hits_a](float, void*) { hits_a++; };
+	AnimationId a = world.CreateAnimation(a_events);
+
+	AnimationEvents b_events;
+	b_events.onUpdate = [&hits_b](float, void*) { hits_b++; };
+
+	float value = 0.0f;
+	InstanceId queued = ANIM_INVALID_INSTANCE;
+
+	AnimationEvents trigger;
+	trigger.onEnd = [&world, &queued, &value, a]() {
+		queued = world.AttachAnimation(a, &value, 1.0f, 1, { });
+		world.RemoveAnimation(a);
+	};
+	AnimationId t = world.CreateAnimation({ });
+	world.AttachAnimation(t, &value, 0.1f, 1, trigger);
+
+	world.UpdateAnimations(0.1f);
+	CHECK(queued.slot_index != ANIM_INVALID_INSTANCE.slot_index);
+	CHECK(!world.HasAnimation(a));
+
+	AnimationId b = world.CreateAnimation(b_events);
+	for (int i = 0; i < 3; ++i) world.UpdateAnimations(0.1f);
+
+	CHECK(hits_a == 3);
+	CHECK(hits_b == 0);
+
+	// Once the instance ends the template is freed and its slot can be reused.
+	world.UpdateAnimations(1.0f);
+	world.UpdateAnimations(0.1f);
+	AnimationId c = world.CreateAnimation(b_events);
+	CHECK(world.HasAnimation(b) && world.HasAnimation(c));
+	CHECK(!world.HasAnimation(a));
+}
+
+static void TestParallelChains() {
+	AnimationWorld world;
+	world.SetWorkerCount(3, 16);
+
+	static const size_t COUNT = 1000;
+	std::vector<float> values(COUNT);
+	std::vector<size_t> chained(COUNT);
+
+	AnimationId id = world.CreateAnimation(Recorder());
+
+	struct Context { AnimationWorld* world; AnimationId id; float* value; size_t* chained; };
+	std::vector<Context> contexts(COUNT);
+
+	for (size_t i = 0; i < COUNT; ++i) {
+		contexts[i] = { &world, id, &values[i], &chained[i] };
+		AnimationEvents events;
+		events.onEnd = [context = &contexts[i]]() {
+			(*context->chained)++;
+			context->world->AttachAnimation(context->id, context->value, 0.1f, 1, { });
+		};
+		world.AttachAnimation(id, &values[i], 0.05f + (i % 5) * 0.01f, 1, events);
+	}
+
+	for (int i = 0; i < 30; ++i) world.UpdateAnimations(1.0f / 60.0f);
+
+	size_t ends = 0;
+	for (size_t count : chained) ends += count;
+	CHECK(ends == COUNT);
+
+	// Many short back-to-back runs of both phases, so a worker that wakes late
+	// meets the next run's queues.
+	for (size_t i = 0; i < COUNT; ++i) world.AttachAnimation(id, &values[i], 0.02f, 0, { });
+	for (int i = 0; i < 2000; ++i) world.UpdateAnimations(1.0f / 240.0f);
+
+	bool in_range = true;
+	for (float value : values) in_range = in_range && value >= 0.0f && value <= 1.0f;
+	CHECK(in_range);
+}
+
+// Tween controls called from parallel callbacks share the command lock with
+// Tween, so pausing one tween while other callbacks create more is safe.
+static void TestParallelTweenControls() {
+	AnimationWorld world;
+	world.SetWorkerCount(3, 16);
+
+	static const size_t COUNT = 512;
+	std::vector<float> values(COUNT);
+	std::vector<float> tweened(COUNT);
+	std::vector<TweenId<float>> tweens(COUNT);
+
+	for (size_t i = 0; i < COUNT; ++i) tweens[i] = world.Tween(&tweened[i], 0.0f, 1.0f, 10.0f);
+
+	AnimationId id = world.CreateAnimation(Recorder());
+
+	struct Context { AnimationWorld* world; TweenId<float> tween; float* tweened; float* value; bool pause; };
+	std::vector<Context> contexts(COUNT);
+
+	for (size_t i = 0; i < COUNT; ++i) {
+		contexts[i] = { &world, tweens[i], &tweened[i], &values[i], i % 2 == 0 };
+		AnimationEvents events;
+		events.onEnd = [context = &contexts[i]]() {
+			if (context->pause) {
+				context->world->Pause(context->tween);
+				if (!context->world->HasTween(context->tween)) *context->tweened = -1.0f;
+			} else {
+				context->world->Tween(context->value, 0.0f, 1.0f, 1.0f);
+			}
+		};
+		world.AttachAnimation(id, &values[i], 0.05f, 1, events);
+	}
+
+	for (int i = 0; i < 10; ++i) world.UpdateAnimations(1.0f / 60.0f);
+
+	std::vector<float> paused(tweened);
+	for (int i = 0; i < 10; ++i) world.UpdateAnimations(1.0f / 60.0f);
+
+	bool held = true;
+	bool moved = true;
+	for (size_t i = 0; i < COUNT; i += 2) held = held && tweened[i] == paused[i] && tweened[i] >= 0.0f;
+	for (size_t i = 1; i < COUNT; i += 2) moved = moved && tweened[i] > paused[i];
+	CHECK(held);
+	CHECK(moved);
+}
+
+// A paused instance is parked: it gets no updates and keeps its progress until
+// it is continued.
+static void TestPause() {
+	AnimationWorld world;
+
+	int updates = 0;
+	AnimationEvents events;
+	events.onUpdate = [&updates](float progress, void* obj) {
+		updates++;
+		*static_cast<float*>(obj) = progress;
+	};
+	AnimationId id = world.CreateAnimation(events);
+
+	float paused = 0.0f;
+	float other = 0.0f;
+	InstanceId a = world.AttachAnimation(id, &paused, 1.0f, 1, { });
+	world.AttachAnimation(id, &other, 1.0f, 1, { });
+
+	world.UpdateAnimations(0.25f);
+	world.Pause(a);
+	updates = 0;
+	world.UpdateAnimations(0.25f);
+
+	CHECK(updates == 1);
+	CHECK(Near(paused, 0.25f));
+	CHECK(Near(other, 0.5f));
+
+	world.Continue(a);
+	world.UpdateAnimations(0.25f);
+
+	CHECK(Near(paused, 0.5f));
+	CHECK(Near(other, 0.75f));
+}
+
+// A removed template's slot is reused under a new generation, so the old id is
+// rejected instead of reaching the new template.
+static void TestStaleAnimationId() {
+	AnimationWorld world;
+
+	AnimationId old_id = world.CreateAnimation(Recorder());
+	world.RemoveAnimation(old_id);
+	AnimationId new_id = world.CreateAnimation(Recorder());
+
+	CHECK(!world.HasAnimation(old_id));
+	CHECK(world.HasAnimation(new_id));
+
+	float progress = 0.0f;
+	bool threw = false;
+	try {
+		world.AttachAnimation(old_id, &progress, 1.0f, 1, { });
+	} catch (const std::out_of_range&) {
+		threw = true;
+	}
+	CHECK(threw);
+}
+
+static void TestBatchAttach() {
+	AnimationWorld world;
+	AnimationId id = world.CreateAnimation(Recorder());
+
+	static const size_t COUNT = 4;
+	float values[COUNT] = { };
+	void* objs[COUNT] = { &values[0], &values[1], &values[2], &values[3] };
+	float durations[COUNT] = { 1.0f, 2.0f, 4.0f, 8.0f };
+	InstanceId ids[COUNT];
+
+	CHECK(world.AttachAnimationBatch(id, objs, COUNT, durations, 1, { }, ids) == COUNT);
+	world.UpdateAnimations(0.5f);
+
+	bool valid = true;
+	for (InstanceId instance : ids) valid = valid && instance.slot_index != ANIM_INVALID_INSTANCE.slot_index;
+	CHECK(valid);
+	CHECK(Near(values[0], 0.5f) && Near(values[1], 0.25f));
+	CHECK(Near(values[2], 0.125f) && Near(values[3], 0.0625f));
+
+	// Many small batches grow the storage geometrically instead of once per batch.
+	static const size_t BATCHES = 1000;
+	std::vector<float> many(BATCHES * COUNT);
+	std::vector<void*> many_objs(many.size());
+	for (size_t i = 0; i < many.size(); ++i) many_objs[i] = &many[i];
+
+	size_t before = world.AllocationCount();
+	for (size_t b = 0; b < BATCHES; ++b) world.AttachAnimationBatch(id, &many_objs[b * COUNT], COUNT, 1.0f, 1, { });
+	if (ANIM_COUNT_ALLOCATIONS) CHECK(world.AllocationCount() - before < BATCHES / 4);
+}
+
+static void TestBulkControls() {
+	AnimationWorld world;
+	AnimationId id = world.CreateAnimation(Recorder());
+
+	float values[4] = { };
+	InstanceId ids[4];
+	for (size_t i = 0; i < 4; ++i) ids[i] = world.AttachAnimation(id, &values[i], 1.0f, 1, { });
+	world.SetTags(ids[2], 1u << 1);
+	world.SetTags(ids[3], 1u << 1 | 1u << 4);
+
+	world.UpdateAnimations(0.25f);
+
+	// The array form touches only the listed ids and skips stale ones.
+	InstanceId listed[3] = { ids[0], ids[1], ANIM_INVALID_INSTANCE };
+	world.Pause(listed, 3);
+	world.PauseAll(1u << 4);
+	world.UpdateAnimations(0.25f);
+
+	CHECK(Near(values[0], 0.25f) && Near(values[1], 0.25f));
+	CHECK(Near(values[2], 0.5f));
+	CHECK(Near(values[3], 0.25f));
+
+	world.Continue(listed, 3);
+	world.ContinueAll(1u << 1);
+	world.UpdateAnimations(0.25f);
+
+	CHECK(Near(values[0], 0.5f) && Near(values[1], 0.5f));
+	CHECK(Near(values[2], 0.75f) && Near(values[3], 0.5f));
+
+	world.RestartAll(1u << 1);
+	world.UpdateAnimations(0.25f);
+	CHECK(Near(values[0], 0.75f));
+	CHECK(Near(values[2], 0.25f) && Near(values[3], 0.25f));
+}
+
+static void TestFreeze() {
+	AnimationWorld world;
+	AnimationId id = world.CreateAnimation(Recorder());
+
+	float frozen = 0.0f;
+	float other = 0.0f;
+	float paused = 0.0f;
+
+	InstanceId a = world.AttachAnimation(id, &frozen, 1.0f, 1, { });
+	InstanceId b = world.AttachAnimation(id, &paused, 1.0f, 1, { });
+	world.AttachAnimation(id, &other, 1.0f, 1, { });
+	world.SetGroup(a, 3);
+	world.SetGroup(b, 3);
+
+	world.UpdateAnimations(0.25f);
+	world.Pause(b);
+	world.Freeze(1u << 3);
+	world.UpdateAnimations(0.25f);
+
+	CHECK(Near(frozen, 0.25f));
+	CHECK(Near(other, 0.5f));
+
+	// A frozen instance that is also paused stays paused once thawed.
+	world.Unfreeze(1u << 3);
+	world.UpdateAnimations(0.25f);
+
+	CHECK(Near(frozen, 0.5f));
+	CHECK(Near(paused, 0.25f));
+	CHECK(Near(other, 0.75f));
+
+	// Hitstop thaws on its own after the given unscaled time.
+	world.SetTimeScale(0.5f);
+	world.Hitstop(1u << 3, 0.2f);
+	world.UpdateAnimations(0.125f);
+	CHECK(Near(frozen, 0.5f));
+	world.UpdateAnimations(0.125f);
+	world.UpdateAnimations(0.125f);
+	CHECK(frozen > 0.5f);
+}
+
+static void TestDirection() {
+	AnimationWorld world;
+	AnimationId id = world.CreateAnimation(Recorder());
+
+	float reversed = 0.0f;
+	float pingpong = 0.0f;
+	float turned = 0.0f;
+
+	InstanceId r = world.AttachAnimation(id, &reversed, 1.0f, 1, { });
+	InstanceId p = world.AttachAnimation(id, &pingpong, 1.0f, 0, { });
+	InstanceId t = world.AttachAnimation(id, &turned, 1.0f, 1, { });
+	world.SetDirection(r, ANIM_REVERSE);
+	world.SetDirection(p, ANIM_PINGPONG);
+
+	world.UpdateAnimations(0.25f);
+	CHECK(Near(reversed, 0.75f));
+	CHECK(Near(pingpong, 0.25f));
+
+	// A running instance turns around from its current progress.
+	world.SetDirection(t, ANIM_REVERSE);
+	world.UpdateAnimations(0.125f);
+	CHECK(Near(turned, 0.125f));
+
+	// The first leg ends on 1 and the second runs backwards from there.
+	world.UpdateAnimations(0.75f);
+	CHECK(Near(pingpong, 1.0f));
+	world.UpdateAnimations(0.25f);
+	CHECK(Near(pingpong, 0.75f));
+	world.UpdateAnimations(0.5f);
+	CHECK(Near(pingpong, 0.25f));
+}
+
+static void TestTimeline() {
+	AnimationWorld world;
+
+	float a = -1.0f;
+	float b = -1.0f;
+	float c = -1.0f;
+	int b_ends = 0;
+
+	AnimationEvents a_events;
+	a_events.onUpdate = [&a](float progress, void*) { a = progress; };
+	AnimationEvents b_events;
+	b_events.onUpdate = [&b](float progress, void*) { b = progress; };
+	b_events.onEnd = [&b_ends]() { b_ends++; };
+	AnimationEvents c_events;
+	c_events.onUpdate = [&c](float progress, void*) { c = progress; };
+
+	Timeline timeline;
+	timeline.Then(world.CreateAnimation(a_events), 1.0f)
+		.With(world.CreateAnimation(b_events), 0.5f, 0.25f)
+		.Wait(0.5f)
+		.Then(world.CreateAnimation(c_events), 1.0f);
+	CHECK(Near(timeline.Duration(), 2.5f));
+
+	AnimationId id = world.CreateTimeline(timeline);
+	float obj = 0.0f;
+	world.AttachAnimation(id, &obj, timeline.Duration(), 1, { });
+
+	world.UpdateAnimations(0.5f);
+	CHECK(Near(a, 0.5f));
+	CHECK(Near(b, 0.5f));
+	CHECK(c < 0.0f);
+
+	// b ends within this frame and c has not started yet: the wait is running.
+	world.UpdateAnimations(0.75f);
+	CHECK(Near(a, 1.0f));
+	CHECK(b_ends == 1);
+	CHECK(c < 0.0f);
+
+	world.UpdateAnimations(0.75f);
+	CHECK(Near(c, 0.5f));
+}
+
+static void TestKeyframes() {
+	AnimationWorld world;
+	AnimationId id = world.CreateKeyframes({
+		{ 0.0f, 0.0f },
+		{ 0.5f, 1.0f },
+		{ 1.0f, 0.0f },
+	}, Recorder());
+
+	float value = -1.0f;
+	InstanceId instance = world.AttachAnimation(id, &value, 1.0f, 1, { });
+
+	world.UpdateAnimations(0.25f);
+	CHECK(Near(value, 0.5f));
+	world.UpdateAnimations(0.25f);
+	CHECK(Near(value, 1.0f));
+	world.UpdateAnimations(0.25f);
+	CHECK(Near(value, 0.5f));
+
+	// Restart jumps back past the cached segment.
+	world.Restart(instance);
+	world.UpdateAnimations(0.125f);
+	CHECK(Near(value, 0.25f));
+}
+
+static void TestCubicBezier() {
+	AnimationWorld world;
+	AnimationId linear = world.CreateAnimation(Recorder(), CubicBezier{ 0.0f, 0.0f, 1.0f, 1.0f });
+	AnimationId ease = world.CreateAnimation(Recorder(), CubicBezier{ 0.25f, 0.1f, 0.25f, 1.0f });
+
+	float a = 0.0f;
+	float b = 0.0f;
+	world.AttachAnimation(linear, &a, 1.0f, 1, { });
+	world.AttachAnimation(ease, &b, 1.0f, 1, { });
+
+	world.UpdateAnimations(0.5f);
+
+	// CSS "ease" at x = 0.5 is y = 0.8024.
+	CHECK(Near(a, 0.5f, 0.01f));
+	CHECK(Near(b, 0.8024f, 0.01f));
+}
+
+// Pools are created from callbacks while the pool lists are being walked, and
+// never as the last pool of the list, so a stale iterator would be used again.
+static void TestCallbacksCreatePools() {
+	AnimationWorld world;
+
+	float value = 0.0f;
+	Pair sprung = { };
+	Triple late = { };
+	bool spring_created = false;
+
+	world.Spring(&value, 1.0f, { }, [&]() {
+		if (spring_created) return;
+		spring_created = true;
+		world.Spring(&late, Triple{ 1.0f, 2.0f, 3.0f });
+	});
+	world.Spring(&sprung, Pair{ 1.0f, 2.0f });
+
+	bool typed_created = false;
+	float outer_value = 0.0f;
+	float other_value = 0.0f;
+	float inner_value = 0.0f;
+	Pair tweened = { };
+
+	auto outer = world.CreateTypedAnimation<float>([&](float, float&) {
+		if (typed_created) return;
+		typed_created = true;
+		auto inner = world.CreateTypedAnimation<float>([](float progress, float& target) { target = progress; });
+		inner.Attach(&inner_value, 1.0f, 1);
+		world.Tween(&tweened, Pair{ 0.0f, 0.0f }, Pair{ 4.0f, 8.0f }, 1.0f);
+	});
+	auto other = world.CreateTypedAnimation<float>([](float progress, float& target) { target = progress; });
+
+	outer.Attach(&outer_value, 10.0f, 1);
+	other.Attach(&other_value, 10.0f, 1);
+
+	for (int i = 0; i < 240; ++i) world.UpdateAnimations(1.0f / 60.0f);
+
+	CHECK(Near(value, 1.0f));
+	CHECK(Near(sprung.a, 1.0f, 0.01f) && Near(sprung.b, 2.0f, 0.01f));
+	CHECK(spring_created);
+	CHECK(Near(late.a, 1.0f, 0.01f) && Near(late.c, 3.0f, 0.01f));
+	CHECK(typed_created);
+	CHECK(inner_value > 0.0f);
+	CHECK(other_value > 0.0f);
+	CHECK(Near(tweened.a, 4.0f) && Near(tweened.b, 8.0f));
+}
+
+// Retargeting keeps the value and its velocity continuous, including while
+// the tween's row is moved by a pause or by erasing another tween.
+static void TestRetarget() {
+	AnimationWorld world;
+
+	const float dt = 1.0f / 120.0f;
+
+	float fillers[3] = { };
+	TweenId<float> others[3];
+	for (size_t i = 0; i < 3; ++i) others[i] = world.Tween(&fillers[i], 0.0f, 1.0f, 4.0f);
+
+	float value = 0.0f;
+	TweenId<float> move = world.Tween(&value, 0.0f, 1.0f, 1.0f, EASE_IN_OUT_CUBIC);
+
+	// Retargeted while paused, so it is the row moved when others[0] is erased.
+	float held = 0.0f;
+	TweenId<float> parked = world.Tween(&held, 0.0f, 1.0f, 1.0f);
+
+	float previous = 0.0f;
+	float velocity = 0.0f;
+	float largest_jump = 0.0f;
+	float previous_held = 0.0f;
+	float largest_step = 0.0f;
+
+	for (int frame = 1; frame <= 240; ++frame) {
+		if (frame == 10) world.Retarget(parked, 2.0f);
+		if (frame == 20) world.Pause(parked);
+		if (frame == 30) world.Retarget(move, 3.0f);
+		if (frame == 40) world.Stop(others[0]);
+		if (frame == 50) world.Pause(others[1]);
+		if (frame == 60) world.Retarget(move, -1.0f);
+		if (frame == 70) world.Continue(others[1]);
+		if (frame == 80) world.Continue(parked);
+
+		world.UpdateAnimations(dt);
+
+		float next_velocity = (value - previous) / dt;
+		if (frame > 1) largest_jump = std::max(largest_jump, std::fabs(next_velocity - velocity));
+		velocity = next_velocity;
+		previous = value;
+
+		// The paused tween does not move, but resuming must not jump either.
+		largest_step = std::max(largest_step, std::fabs(held - previous_held));
+		previous_held = held;
+
+		if (frame == 100) CHECK(world.HasTween(move));
+	}
+
+	CHECK(largest_jump < 0.5f);
+	CHECK(Near(value, -1.0f));
+	CHECK(Near(held, 2.0f));
+	CHECK(largest_step < 0.04f);
+
+	bool in_range = true;
+	for (float filler : fillers) in_range = in_range && filler >= 0.0f && filler <= 1.0f;
+	CHECK(in_range);
+}
+
+int main() {
+
+	TestDelays();
+	TestParallelChains();
+	TestDeferredAttach();
+	TestParallelTweenControls();
+	TestPause();
+	TestStaleAnimationId();
+	TestBatchAttach();
+	TestBulkControls();
+	TestFreeze();
+	TestDirection();
+	TestTimeline();
+	TestKeyframes();
+	TestCubicBezier();
+	TestCallbacksCreatePools();
+	TestRetarget();
+
+	if (g_failures == 0) printf("all checks passed\n");
+	return g_failures == 0 ? 0 : 1;
+}
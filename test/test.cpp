@@ -10,6 +10,7 @@ int main() {
 
 	Rectangle rect = { 0.0f, 0.0f, 0.0f, 0.0f };
 	Rectangle rect2 = { 0.0f, 0.0f, 0.0f, 0.0f };
+	Rectangle rect3 = { 0.0f, 0.0f, 0.0f, 0.0f };
 
 	AnimationId rect_to_screen_size = AnimationHandler::CreateAnimation({
 		.onUpdate = [](float progress, void* obj){
@@ -45,6 +46,12 @@ int main() {
 		}
 	});
 
+	// Grows and shrinks back forever instead of snapping to zero every cycle.
+	InstanceId ping_pong = AnimationHandler::AttachAnimation(rect_to_screen_size, &rect3, 1.5f, 0, {
+		.onEachRepeatEnd = [](void*){ }
+	});
+	AnimationHandler::SetDirection(ping_pong, ANIM_PINGPONG);
+
 	float gt = 0;
 
 	while(!WindowShouldClose()) {
@@ -63,6 +70,7 @@ int main() {
 
 		DrawRectangleRec(rect, WHITE);
 		DrawRectangleRec(rect2, RED);
+		DrawRectangleLinesEx(rect3, 4.0f, BLUE);
 
 		EndDrawing();
 	}